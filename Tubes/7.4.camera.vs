@@ -1,19 +1,46 @@
 #version 330 core
+// island vertices are packed (see PackedVertex in scene_pack.h): 16-bit normalized
+// position inside the object's bounds, RGBA8 color and the object index
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aColor;
-layout (location = 2) in vec2 aTexCoord;
+layout (location = 2) in uint aObject;
+// per-instance placement (see InstanceData in learnopengl/instance_buffer.h), applied
+// before model; plain draws leave these disabled and get the identity (0, 0, 0, 1)
+layout (location = 3) in vec4 aInstanceOffset;		// xyz translation, w uniform scale
+layout (location = 4) in vec4 aInstanceRotation;	// unit quaternion (x, y, z, w)
 
+const int MAX_OBJECTS = 32;
 
 out vec2 TexCoord;
 out vec3 ourColor;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+
+// per-frame camera data, must match CameraBlockData in learnopengl/camera_block.h
+layout (std140) uniform CameraBlock
+{
+	mat4 view;
+	mat4 projection;
+	mat4 viewProjection;
+	mat4 skyboxView;
+	vec4 cameraPosition;
+	float time;
+};
+
+// object space bounds of every island object, set once after the pack is loaded
+uniform vec3 boundsMin[MAX_OBJECTS];
+uniform vec3 boundsSize[MAX_OBJECTS];
+
+vec3 rotate(vec4 q, vec3 v)
+{
+	return v + 2.0f * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
 
 void main()
 {
-	gl_Position = projection * view * model * vec4(aPos, 1.0f);
+	vec3 position = boundsMin[aObject] + aPos * boundsSize[aObject];
+	position = rotate(aInstanceRotation, position * aInstanceOffset.w) + aInstanceOffset.xyz;
+	gl_Position = viewProjection * model * vec4(position, 1.0f);
 	ourColor = aColor;
-	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+	TexCoord = vec2(0.0f, 0.0f);
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include"VAO.h"
+#include"learnopengl/gl_state.h"
 
 // Constructor that generates a VAO ID
 VAO::VAO()
@@ -18,18 +19,18 @@ void VAO::LinkAttrib(VBO& VBO, GLuint layout, GLuint numComponents, GLenum type,
 // Binds the VAO
 void VAO::Bind()
 {
-	glBindVertexArray(ID);
+	glState.bindVertexArray(ID);
 }
 
 // Unbinds the VAO
 void VAO::Unbind()
 {
-	glBindVertexArray(0);
+	glState.bindVertexArray(0);
 }
 
 // Deletes the VAO
 void VAO::Delete()
 {
-	glDeleteVertexArrays(1, &ID);
+	glState.deleteVertexArray(ID);
 }
 
@@ -0,0 +1,521 @@
+#ifndef BOUNDS_TREE_H
+#define BOUNDS_TREE_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/frustum.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// one item for BoundsTree::build: caller's id and world space box
+struct BoundsTreeItem {
+    uint32_t id;
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+struct BoundsTreeRayHit {
+    uint32_t id;
+    float distance;     // along the ray to where it enters the item's box
+};
+
+// Dynamic AABB tree with one item per leaf, over ids the caller picks (a SceneGraph
+// NodeId, an index, ...). build() does a binned SAH split of every item at once;
+// after that items can be moved (the leaf's ancestors are refit on the way up),
+// inserted (next to the sibling that grows the least) or removed without a rebuild.
+// Queries descend from the root and drop every branch whose box misses, so they
+// cost about O(results + log n) instead of a test per item.
+//
+// Refitting keeps the tree valid but not good: once items moved far, boxes overlap
+// more and queries slow down. The summed area of the inner boxes (what the SAH
+// minimizes) is tracked through every change; needsRebuild() turns true once it has
+// doubled since the last build, and rebuild() redoes the SAH build from the current
+// boxes.
+class BoundsTree
+{
+public:
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+    void clear()
+    {
+        m_nodes.clear();
+        m_free.clear();
+        m_leafOf.clear();
+        m_root = NONE;
+        m_items = 0;
+        m_innerArea = 0.0f;
+        m_builtArea = 0.0f;
+    }
+
+    void build(const std::vector<BoundsTreeItem>& items)
+    {
+        clear();
+        if (items.empty())
+            return;
+        m_nodes.reserve(items.size() * 2);
+        m_building = items;
+        uint32_t maxId = 0;
+        for (const BoundsTreeItem& item : items)
+            maxId = std::max(maxId, item.id);
+        m_leafOf.assign(maxId + 1, NONE);
+        m_root = buildRange(0, static_cast<uint32_t>(items.size()), NONE);
+        m_items = static_cast<uint32_t>(items.size());
+        m_builtArea = m_innerArea;
+        m_building.clear();
+    }
+
+    // every item as it is now, built again from scratch
+    void rebuild()
+    {
+        std::vector<BoundsTreeItem> items;
+        items.reserve(m_items);
+        for (uint32_t id = 0; id < m_leafOf.size(); id++)
+        {
+            if (m_leafOf[id] != NONE)
+                items.push_back({ id, m_nodes[m_leafOf[id]].min, m_nodes[m_leafOf[id]].max });
+        }
+        build(items);
+    }
+
+    bool needsRebuild() const
+    {
+        return m_innerArea > 2.0f * m_builtArea && m_items > 2;
+    }
+
+    bool contains(uint32_t id) const
+    {
+        return id < m_leafOf.size() && m_leafOf[id] != NONE;
+    }
+
+    uint32_t size() const
+    {
+        return m_items;
+    }
+
+    void insert(uint32_t id, const glm::vec3& min, const glm::vec3& max)
+    {
+        if (id >= m_leafOf.size())
+            m_leafOf.resize(id + 1, NONE);
+        const uint32_t leaf = allocate();
+        m_nodes[leaf] = { min, max, NONE, NONE, NONE, id };
+        m_leafOf[id] = leaf;
+        m_items++;
+        if (m_root == NONE)
+        {
+            m_root = leaf;
+            return;
+        }
+
+        // walk down to the node whose box grows the least by taking this one in
+        uint32_t sibling = m_root;
+        while (!isLeaf(sibling))
+        {
+            const Node& node = m_nodes[sibling];
+            const float leftGrowth = area(merge(m_nodes[node.left], min, max)) - area(m_nodes[node.left]);
+            const float rightGrowth = area(merge(m_nodes[node.right], min, max)) - area(m_nodes[node.right]);
+            sibling = leftGrowth <= rightGrowth ? node.left : node.right;
+        }
+
+        const uint32_t oldParent = m_nodes[sibling].parent;
+        const uint32_t parent = allocate();
+        m_nodes[parent] = { glm::min(m_nodes[sibling].min, min), glm::max(m_nodes[sibling].max, max), oldParent, sibling, leaf, NONE };
+        m_innerArea += area(m_nodes[parent]);
+        m_nodes[sibling].parent = parent;
+        m_nodes[leaf].parent = parent;
+        if (oldParent == NONE)
+            m_root = parent;
+        else if (m_nodes[oldParent].left == sibling)
+            m_nodes[oldParent].left = parent;
+        else
+            m_nodes[oldParent].right = parent;
+        refit(oldParent);
+    }
+
+    void remove(uint32_t id)
+    {
+        if (!contains(id))
+            return;
+        const uint32_t leaf = m_leafOf[id];
+        m_leafOf[id] = NONE;
+        m_items--;
+        const uint32_t parent = m_nodes[leaf].parent;
+        release(leaf);
+        if (parent == NONE)
+        {
+            m_root = NONE;
+            return;
+        }
+
+        // the sibling takes the parent's place
+        const uint32_t sibling = m_nodes[parent].left == leaf ? m_nodes[parent].right : m_nodes[parent].left;
+        const uint32_t grandParent = m_nodes[parent].parent;
+        m_nodes[sibling].parent = grandParent;
+        if (grandParent == NONE)
+            m_root = sibling;
+        else if (m_nodes[grandParent].left == parent)
+            m_nodes[grandParent].left = sibling;
+        else
+            m_nodes[grandParent].right = sibling;
+        m_innerArea -= area(m_nodes[parent]);
+        release(parent);
+        refit(grandParent);
+    }
+
+    // new box for an item, inserting it if it isn't in the tree yet
+    void update(uint32_t id, const glm::vec3& min, const glm::vec3& max)
+    {
+        if (!contains(id))
+        {
+            insert(id, min, max);
+            return;
+        }
+        Node& leaf = m_nodes[m_leafOf[id]];
+        if (leaf.min == min && leaf.max == max)
+            return;
+        leaf.min = min;
+        leaf.max = max;
+        refit(leaf.parent);
+    }
+
+    // ids of the items whose box is inside or crossing the frustum, in no particular order
+    void cullFrustum(const Frustum& frustum, std::vector<uint32_t>& visible)
+    {
+        visible.clear();
+        m_visited = 0;
+        if (m_root == NONE)
+            return;
+        const Plan* planes[6] = { &frustum.leftFace, &frustum.rightFace, &frustum.topFace,
+                                  &frustum.bottomFace, &frustum.nearFace, &frustum.farFace };
+
+        // each entry carries the planes its box still straddles; a box entirely in
+        // front of a plane has children that are too, so they skip that plane
+        m_stack.clear();
+        m_stack.push_back({ m_root, 0x3F });
+        while (!m_stack.empty())
+        {
+            const StackEntry entry = m_stack.back();
+            m_stack.pop_back();
+            m_visited++;
+            const Node& node = m_nodes[entry.node];
+            const glm::vec3 center = (node.min + node.max) * 0.5f;
+            const glm::vec3 extents = (node.max - node.min) * 0.5f;
+
+            uint32_t straddled = 0;
+            bool outside = false;
+            for (int p = 0; p < 6 && !outside; p++)
+            {
+                if (!(entry.planes & (1u << p)))
+                    continue;
+                const float distance = planes[p]->getSignedDistanceToPlan(center);
+                const float radius = extents.x * std::abs(planes[p]->normal.x) + extents.y * std::abs(planes[p]->normal.y) +
+                    extents.z * std::abs(planes[p]->normal.z);
+                if (!(distance + radius >= 0.0f))
+                    outside = true;
+                else if (distance - radius < 0.0f)
+                    straddled |= 1u << p;
+            }
+            if (outside)
+                continue;
+            if (straddled == 0)
+                collectLeaves(entry.node, visible);
+            else if (isLeaf(entry.node))
+                visible.push_back(node.item);
+            else
+            {
+                m_stack.push_back({ node.left, straddled });
+                m_stack.push_back({ node.right, straddled });
+            }
+        }
+    }
+
+    // items whose box the ray enters within maxDistance, nearest first; direction
+    // doesn't have to be normalized, distances are in units of its length
+    void raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<BoundsTreeRayHit>& hits)
+    {
+        hits.clear();
+        m_visited = 0;
+        if (m_root == NONE)
+            return;
+        const glm::vec3 inverse = 1.0f / direction;    // +-inf for axis aligned rays, which the slab test handles
+        m_stack.clear();
+        m_stack.push_back({ m_root, 0 });
+        while (!m_stack.empty())
+        {
+            const uint32_t index = m_stack.back().node;
+            m_stack.pop_back();
+            m_visited++;
+            const Node& node = m_nodes[index];
+            float entry;
+            if (!rayHitsBox(origin, inverse, maxDistance, node, entry))
+                continue;
+            if (isLeaf(index))
+                hits.push_back({ node.item, entry });
+            else
+            {
+                m_stack.push_back({ node.left, 0 });
+                m_stack.push_back({ node.right, 0 });
+            }
+        }
+        std::sort(hits.begin(), hits.end(), [](const BoundsTreeRayHit& a, const BoundsTreeRayHit& b) { return a.distance < b.distance; });
+    }
+
+    // ids of the items whose box touches [min, max]
+    void overlap(const glm::vec3& min, const glm::vec3& max, std::vector<uint32_t>& results)
+    {
+        results.clear();
+        m_visited = 0;
+        if (m_root == NONE)
+            return;
+        m_stack.clear();
+        m_stack.push_back({ m_root, 0 });
+        while (!m_stack.empty())
+        {
+            const uint32_t index = m_stack.back().node;
+            m_stack.pop_back();
+            m_visited++;
+            const Node& node = m_nodes[index];
+            if (glm::any(glm::lessThan(node.max, min)) || glm::any(glm::greaterThan(node.min, max)))
+                continue;
+            if (isLeaf(index))
+                results.push_back(node.item);
+            else
+            {
+                m_stack.push_back({ node.left, 0 });
+                m_stack.push_back({ node.right, 0 });
+            }
+        }
+    }
+
+    // nodes the last query looked at, to see how much of the tree it skipped
+    uint32_t visitedNodes() const
+    {
+        return m_visited;
+    }
+
+private:
+    static constexpr uint32_t BINS = 12;
+
+    struct Node {
+        glm::vec3 min;
+        glm::vec3 max;
+        uint32_t parent;
+        uint32_t left;      // NONE for leaves
+        uint32_t right;
+        uint32_t item;      // leaves only
+    };
+
+    struct StackEntry {
+        uint32_t node;
+        uint32_t planes;
+    };
+
+    struct Box {
+        glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+        void grow(const glm::vec3& pointMin, const glm::vec3& pointMax)
+        {
+            min = glm::min(min, pointMin);
+            max = glm::max(max, pointMax);
+        }
+    };
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_free;
+    std::vector<uint32_t> m_leafOf;     // leaf node of every id, NONE if not in the tree
+    std::vector<BoundsTreeItem> m_building;
+    std::vector<StackEntry> m_stack;
+    uint32_t m_root = NONE;
+    uint32_t m_items = 0;
+    float m_innerArea = 0.0f;   // summed area of the inner nodes' boxes
+    float m_builtArea = 0.0f;   // and what it was right after the last build
+    uint32_t m_visited = 0;
+
+    bool isLeaf(uint32_t node) const
+    {
+        return m_nodes[node].left == NONE;
+    }
+
+    // half the surface area, all the SAH needs
+    static float area(const glm::vec3& min, const glm::vec3& max)
+    {
+        const glm::vec3 size = glm::max(max - min, glm::vec3(0.0f));
+        return size.x * size.y + size.y * size.z + size.z * size.x;
+    }
+
+    static float area(const Node& node)
+    {
+        return area(node.min, node.max);
+    }
+
+    static float area(const Box& box)
+    {
+        return area(box.min, box.max);
+    }
+
+    static Box merge(const Node& node, const glm::vec3& min, const glm::vec3& max)
+    {
+        Box box;
+        box.grow(node.min, node.max);
+        box.grow(min, max);
+        return box;
+    }
+
+    uint32_t allocate()
+    {
+        if (!m_free.empty())
+        {
+            const uint32_t node = m_free.back();
+            m_free.pop_back();
+            return node;
+        }
+        m_nodes.push_back({});
+        return static_cast<uint32_t>(m_nodes.size() - 1);
+    }
+
+    void release(uint32_t node)
+    {
+        m_free.push_back(node);
+    }
+
+    // boxes of node and its ancestors from their children, until one doesn't change
+    void refit(uint32_t node)
+    {
+        while (node != NONE)
+        {
+            Node& parent = m_nodes[node];
+            const glm::vec3 min = glm::min(m_nodes[parent.left].min, m_nodes[parent.right].min);
+            const glm::vec3 max = glm::max(m_nodes[parent.left].max, m_nodes[parent.right].max);
+            if (min == parent.min && max == parent.max)
+                return;
+            m_innerArea += area(min, max) - area(parent);
+            parent.min = min;
+            parent.max = max;
+            node = parent.parent;
+        }
+    }
+
+    // every item below root, with no more tests
+    void collectLeaves(uint32_t root, std::vector<uint32_t>& items)
+    {
+        const size_t base = m_stack.size();
+        uint32_t index = root;
+        while (true)
+        {
+            if (isLeaf(index))
+                items.push_back(m_nodes[index].item);
+            else
+            {
+                m_stack.push_back({ m_nodes[index].left, 0 });
+                m_stack.push_back({ m_nodes[index].right, 0 });
+            }
+            if (m_stack.size() == base)
+                return;
+            index = m_stack.back().node;
+            m_stack.pop_back();
+            m_visited++;
+        }
+    }
+
+    static bool rayHitsBox(const glm::vec3& origin, const glm::vec3& inverse, float maxDistance, const Node& node, float& entry)
+    {
+        const glm::vec3 t0 = (node.min - origin) * inverse;
+        const glm::vec3 t1 = (node.max - origin) * inverse;
+        const glm::vec3 tNear = glm::min(t0, t1);
+        const glm::vec3 tFar = glm::max(t0, t1);
+        entry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+        const float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+        return entry <= exit;
+    }
+
+    // binned SAH split of m_building[begin, end), returns the subtree's node
+    uint32_t buildRange(uint32_t begin, uint32_t end, uint32_t parent)
+    {
+        const uint32_t index = allocate();
+        if (end - begin == 1)
+        {
+            const BoundsTreeItem& item = m_building[begin];
+            m_nodes[index] = { item.min, item.max, parent, NONE, NONE, item.id };
+            m_leafOf[item.id] = index;
+            return index;
+        }
+
+        Box bounds, centroids;
+        for (uint32_t i = begin; i < end; i++)
+        {
+            const glm::vec3 centroid = (m_building[i].min + m_building[i].max) * 0.5f;
+            bounds.grow(m_building[i].min, m_building[i].max);
+            centroids.grow(centroid, centroid);
+        }
+
+        const glm::vec3 spread = centroids.max - centroids.min;
+        const int axis = spread.x >= spread.y && spread.x >= spread.z ? 0 : (spread.y >= spread.z ? 1 : 2);
+        uint32_t middle = begin + (end - begin) / 2;
+        // two items split one way only; everything else goes through the bins
+        if (end - begin > 2 && spread[axis] > 0.0f)
+        {
+            const float binScale = BINS / spread[axis];
+            auto binOf = [&](const BoundsTreeItem& item) {
+                const float centroid = (item.min[axis] + item.max[axis]) * 0.5f;
+                return std::min(BINS - 1, static_cast<uint32_t>((centroid - centroids.min[axis]) * binScale));
+            };
+
+            Box bins[BINS];
+            uint32_t counts[BINS] = {};
+            for (uint32_t i = begin; i < end; i++)
+            {
+                const uint32_t bin = binOf(m_building[i]);
+                bins[bin].grow(m_building[i].min, m_building[i].max);
+                counts[bin]++;
+            }
+
+            // cost of splitting after each bin: area times items on either side
+            float leftCost[BINS - 1];
+            Box left;
+            uint32_t leftCount = 0;
+            for (uint32_t bin = 0; bin < BINS - 1; bin++)
+            {
+                if (counts[bin])
+                    left.grow(bins[bin].min, bins[bin].max);
+                leftCount += counts[bin];
+                leftCost[bin] = leftCount ? area(left) * leftCount : 0.0f;
+            }
+            float bestCost = std::numeric_limits<float>::max();
+            uint32_t bestSplit = 0;
+            Box right;
+            uint32_t rightCount = 0;
+            for (uint32_t bin = BINS - 1; bin > 0; bin--)
+            {
+                if (counts[bin])
+                    right.grow(bins[bin].min, bins[bin].max);
+                rightCount += counts[bin];
+                const float cost = leftCost[bin - 1] + (rightCount ? area(right) * rightCount : 0.0f);
+                if (rightCount > 0 && rightCount < end - begin && cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestSplit = bin;
+                }
+            }
+
+            if (bestSplit > 0)
+            {
+                auto split = std::partition(m_building.begin() + begin, m_building.begin() + end,
+                                            [&](const BoundsTreeItem& item) { return binOf(item) < bestSplit; });
+                middle = static_cast<uint32_t>(split - m_building.begin());
+            }
+        }
+        if (middle == begin || middle == end)
+            middle = begin + (end - begin) / 2;
+
+        const uint32_t leftChild = buildRange(begin, middle, index);
+        const uint32_t rightChild = buildRange(middle, end, index);
+        m_nodes[index] = { bounds.min, bounds.max, parent, leftChild, rightChild, NONE };
+        m_innerArea += area(bounds);
+        return index;
+    }
+};
+#endif
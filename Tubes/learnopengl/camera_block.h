@@ -0,0 +1,115 @@
+#ifndef CAMERA_BLOCK_H
+#define CAMERA_BLOCK_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/frame_stats.h>
+
+#include <cstddef>
+#include <cstring>
+
+// uniform buffer binding point of CameraBlock, shared by every program
+const GLuint CAMERA_BLOCK_BINDING = 0;
+
+// CPU side of the std140 block every vertex shader declares as:
+//   layout (std140) uniform CameraBlock
+//   {
+//       mat4 view;
+//       mat4 projection;
+//       mat4 viewProjection;
+//       mat4 skyboxView;        // view without the translation
+//       vec4 cameraPosition;    // xyz
+//       float time;
+//   };
+struct CameraBlockData {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::mat4 skyboxView;
+    glm::vec4 cameraPosition;
+    float     time;
+    float     padding[3];
+};
+
+static_assert(sizeof(CameraBlockData) == 288, "CameraBlockData must match the std140 layout of CameraBlock");
+
+// points the program's CameraBlock (if it has one) at CAMERA_BLOCK_BINDING; block
+// bindings are program state, so this runs after every link or binary restore
+inline void bindCameraBlock(unsigned int program)
+{
+    GLuint index = glGetUniformBlockIndex(program, "CameraBlock");
+    if (index != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, index, CAMERA_BLOCK_BINDING);
+}
+
+// The uniform buffer behind CameraBlock. update() runs once per frame: the matrices
+// are only recomputed and uploaded when the camera or the projection changed, the
+// time on its own is a 4 byte upload.
+class CameraBlock
+{
+public:
+    unsigned int UBO = 0;
+
+    void create()
+    {
+        glGenBuffers(1, &UBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlockData), NULL, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, UBO);
+    }
+
+    void destroy()
+    {
+        glDeleteBuffers(1, &UBO);
+        UBO = 0;
+    }
+
+    // CameraT is camera.h's Camera, or anything with Position, Front, Up, Zoom and
+    // GetViewMatrix()
+    template<typename CameraT>
+    void update(CameraT& camera, float aspect, float nearPlane, float farPlane, float time)
+    {
+        const float inputs[] = { camera.Position.x, camera.Position.y, camera.Position.z, camera.Front.x, camera.Front.y, camera.Front.z,
+                                 camera.Up.x, camera.Up.y, camera.Up.z, camera.Zoom, aspect, nearPlane, farPlane };
+        static_assert(sizeof(inputs) == sizeof(m_inputs), "camera inputs changed");
+        const bool cameraChanged = !m_valid || std::memcmp(inputs, m_inputs, sizeof(inputs)) != 0;
+        const bool timeChanged = !m_valid || time != m_data.time;
+        if (!cameraChanged && !timeChanged)
+            return;
+
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        if (cameraChanged)
+        {
+            std::memcpy(m_inputs, inputs, sizeof(inputs));
+            m_data.view = camera.GetViewMatrix();
+            m_data.projection = glm::perspective(glm::radians(camera.Zoom), aspect, nearPlane, farPlane);
+            m_data.viewProjection = m_data.projection * m_data.view;
+            m_data.skyboxView = glm::mat4(glm::mat3(m_data.view));
+            m_data.cameraPosition = glm::vec4(camera.Position, 1.0f);
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, offsetof(CameraBlockData, time), &m_data);
+            frameStats.uniformUploads++;
+        }
+        if (timeChanged)
+        {
+            m_data.time = time;
+            glBufferSubData(GL_UNIFORM_BUFFER, offsetof(CameraBlockData, time), sizeof(float), &m_data.time);
+            frameStats.uniformUploads++;
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        m_valid = true;
+    }
+
+    const CameraBlockData& data() const
+    {
+        return m_data;
+    }
+
+private:
+    CameraBlockData m_data = {};
+    float m_inputs[13] = {};
+    bool m_valid = false;
+};
+#endif
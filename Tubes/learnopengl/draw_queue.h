@@ -0,0 +1,186 @@
+#ifndef DRAW_QUEUE_H
+#define DRAW_QUEUE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/frame_stats.h>
+#include <learnopengl/mesh.h>
+#include <learnopengl/shader.h>
+
+#include <cstdint>
+#include <vector>
+
+// passes are submitted in this order; opaque draws go front to back grouped by state,
+// transparent ones strictly back to front
+enum DrawPass {
+    DRAW_PASS_OPAQUE = 0,
+    DRAW_PASS_TRANSPARENT = 1
+};
+
+// One mesh draw collected during traversal. The model matrix is pointed to, not
+// copied, so it has to stay put until submit().
+struct DrawPacket {
+    uint64_t key;
+    Mesh* mesh;
+    Shader* shader;
+    const glm::mat4* model;
+};
+
+// state changes the queue's packets cost in the order they were added and in the
+// sorted order they were actually submitted (program, material and VAO switches)
+struct DrawQueueStats {
+    unsigned int packets = 0;
+    unsigned int stateChangesInOrder = 0;
+    unsigned int stateChangesSorted = 0;
+
+    unsigned int stateChangesSaved() const
+    {
+        return stateChangesInOrder > stateChangesSorted ? stateChangesInOrder - stateChangesSorted : 0;
+    }
+};
+
+// Collects draw packets, radix sorts them on a 64-bit key and submits them in key
+// order. Key layout, most significant bits first:
+//   opaque:       pass:2 | program:10 | material:16 | VAO:12 | depth:24
+//   transparent:  pass:2 | far-to-near depth:24 | program:10 | material:16 | VAO:12
+// Program and VAO are their GL names masked to the field, the material is a hash of
+// the mesh's texture ids. A clash only costs grouping, never correctness: every
+// packet is drawn with its own shader and mesh.
+class DrawQueue
+{
+public:
+    // depth of a point is dot(forward, point) - offset, mapped over [0, range] to the
+    // 24-bit key field; for a camera: begin(cam.Front, dot(cam.Front, cam.Position), far)
+    void begin(const glm::vec3& forward, float offset, float range)
+    {
+        m_packets.clear();
+        m_forward = forward;
+        m_offset = offset;
+        m_depthScale = range > 0.0f ? float(DEPTH_MASK) / range : 0.0f;
+    }
+
+    void add(DrawPass pass, Shader& shader, Mesh& mesh, const glm::mat4& model, const glm::vec3& center)
+    {
+        const uint64_t depth = quantizeDepth(glm::dot(m_forward, center) - m_offset);
+        const uint64_t state = (uint64_t(shader.ID & PROGRAM_MASK) << 28) | (uint64_t(materialKey(mesh)) << 12) | (mesh.VAO & VAO_MASK);
+        uint64_t key = uint64_t(pass) << 62;
+        if (pass == DRAW_PASS_OPAQUE)
+            key |= (state << 24) | depth;
+        else
+            key |= ((DEPTH_MASK - depth) << 38) | state;
+        m_packets.push_back({ key, &mesh, &shader, &model });
+    }
+
+    // sorts and draws everything added since begin()
+    void submit()
+    {
+        sort();
+        m_stats.packets = static_cast<unsigned int>(m_packets.size());
+        m_stats.stateChangesInOrder = 0;
+        m_stats.stateChangesSorted = 0;
+        for (size_t i = 1; i < m_packets.size(); i++)
+        {
+            m_stats.stateChangesInOrder += stateChanges(m_packets[i - 1], m_packets[i]);
+            m_stats.stateChangesSorted += stateChanges(m_packets[m_order[i - 1].packet], m_packets[m_order[i].packet]);
+        }
+
+        const Shader* lastShader = nullptr;
+        const glm::mat4* lastModel = nullptr;
+        for (const SortEntry& entry : m_order)
+        {
+            DrawPacket& packet = m_packets[entry.packet];
+            packet.shader->use();
+            // consecutive meshes of one entity share the matrix; a new program needs it again
+            if (packet.shader != lastShader || packet.model != lastModel)
+            {
+                packet.shader->setMat4("model"_uniform, *packet.model);
+                frameStats.uniformUploads++;
+            }
+            packet.mesh->Draw(*packet.shader);
+            frameStats.drawCalls++;
+            lastShader = packet.shader;
+            lastModel = packet.model;
+        }
+    }
+
+    const DrawQueueStats& stats() const
+    {
+        return m_stats;
+    }
+
+private:
+    static const uint64_t DEPTH_MASK = (1ull << 24) - 1;
+    static const uint32_t PROGRAM_MASK = (1u << 10) - 1;
+    static const uint32_t VAO_MASK = (1u << 12) - 1;
+
+    struct SortEntry {
+        uint64_t key;
+        uint32_t packet;
+    };
+
+    std::vector<DrawPacket> m_packets;
+    std::vector<SortEntry> m_order;
+    std::vector<SortEntry> m_scratch;
+    glm::vec3 m_forward = glm::vec3(0.0f, 0.0f, -1.0f);
+    float m_offset = 0.0f;
+    float m_depthScale = 0.0f;
+    DrawQueueStats m_stats;
+
+    uint64_t quantizeDepth(float depth) const
+    {
+        float scaled = depth * m_depthScale;
+        if (!(scaled > 0.0f))
+            return 0;
+        return scaled >= float(DEPTH_MASK) ? DEPTH_MASK : uint64_t(scaled);
+    }
+
+    // 16-bit FNV-1a fold of the mesh's texture ids (and upload ids, for streamed ones)
+    static uint32_t materialKey(const Mesh& mesh)
+    {
+        uint32_t hash = 2166136261u;
+        for (const Texture& texture : mesh.textures)
+        {
+            hash = (hash ^ texture.id) * 16777619u;
+            hash = (hash ^ texture.upload) * 16777619u;
+        }
+        return (hash ^ (hash >> 16)) & 0xFFFF;
+    }
+
+    static unsigned int stateChanges(const DrawPacket& a, const DrawPacket& b)
+    {
+        return (a.shader->ID != b.shader->ID ? 1 : 0) + (materialKey(*a.mesh) != materialKey(*b.mesh) ? 1 : 0) + (a.mesh->VAO != b.mesh->VAO ? 1 : 0);
+    }
+
+    // LSD radix sort on the key, one byte per pass; a byte that is the same in every
+    // key (most of them for small queues) is skipped. Stable, so equal keys keep
+    // their traversal order.
+    void sort()
+    {
+        const size_t count = m_packets.size();
+        m_order.resize(count);
+        m_scratch.resize(count);
+        for (size_t i = 0; i < count; i++)
+            m_order[i] = { m_packets[i].key, static_cast<uint32_t>(i) };
+
+        for (unsigned int shift = 0; shift < 64; shift += 8)
+        {
+            size_t offsets[256] = {};
+            for (const SortEntry& entry : m_order)
+                offsets[(entry.key >> shift) & 0xFF]++;
+            if (count == 0 || offsets[(m_order[0].key >> shift) & 0xFF] == count)
+                continue;
+            size_t total = 0;
+            for (size_t& offset : offsets)
+            {
+                size_t bucket = offset;
+                offset = total;
+                total += bucket;
+            }
+            for (const SortEntry& entry : m_order)
+                m_scratch[offsets[(entry.key >> shift) & 0xFF]++] = entry;
+            m_order.swap(m_scratch);
+        }
+    }
+};
+#endif
@@ -0,0 +1,188 @@
+#ifndef DRAW_RANGE_H
+#define DRAW_RANGE_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/frame_stats.h>
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+// Exact extent of one triangle draw, taken from the real buffer contents when the
+// buffers are uploaded. Build with VALIDATE_DRAW_RANGES to check every draw against
+// the buffers actually bound to its VAO before it reaches the driver.
+struct DrawRange {
+    unsigned int VAO = 0;
+    GLenum   indexType = 0;     // 0 for glDrawArrays, else GL_UNSIGNED_SHORT / GL_UNSIGNED_INT
+    GLint    first = 0;         // first vertex (glDrawArrays only)
+    GLsizei  count = 0;         // vertices (glDrawArrays) or indices (glDrawElements)
+    GLsizei  vertexCount = 0;   // vertices the range owns, starting at baseVertex
+    GLuint   maxIndex = 0;      // largest index referenced (glDrawElements only)
+    GLint    baseVertex = 0;    // added to every index, for meshes sharing one VBO
+    GLintptr indexOffset = 0;   // byte offset of the first index in the element buffer
+};
+
+inline DrawRange arrayDrawRange(unsigned int VAO, GLint first, GLsizei count)
+{
+    DrawRange range;
+    range.VAO = VAO;
+    range.first = first;
+    range.count = count;
+    range.vertexCount = first + count;
+    return range;
+}
+
+inline DrawRange elementDrawRange(unsigned int VAO, GLenum indexType, const void* indices, GLsizei count, GLsizei vertexCount,
+                                  GLint baseVertex = 0, GLintptr indexOffset = 0)
+{
+    DrawRange range;
+    range.VAO = VAO;
+    range.indexType = indexType;
+    range.count = count;
+    range.vertexCount = vertexCount;
+    range.baseVertex = baseVertex;
+    range.indexOffset = indexOffset;
+    for (GLsizei i = 0; i < count; i++)
+    {
+        GLuint index = (indexType == GL_UNSIGNED_SHORT) ? static_cast<const uint16_t*>(indices)[i] : static_cast<const uint32_t*>(indices)[i];
+        if (index > range.maxIndex)
+            range.maxIndex = index;
+    }
+    return range;
+}
+
+inline GLsizei indexTypeSize(GLenum indexType)
+{
+    return indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+}
+
+// Several indexed ranges that share a VAO, an index type and all their uniforms,
+// submitted with a single glMultiDrawElementsBaseVertex
+struct MultiDrawBatch {
+    unsigned int VAO = 0;
+    GLenum indexType = 0;
+    std::vector<GLsizei>     counts;
+    std::vector<const void*> offsets;
+    std::vector<GLint>       baseVertices;
+#ifdef VALIDATE_DRAW_RANGES
+    std::vector<DrawRange>   ranges;
+#endif
+
+    // returns false if the range can't join this batch
+    bool add(const DrawRange& range)
+    {
+        if (range.indexType == 0 || range.VAO != VAO || (indexType != 0 && range.indexType != indexType))
+            return false;
+        indexType = range.indexType;
+        counts.push_back(range.count);
+        offsets.push_back(reinterpret_cast<const void*>(range.indexOffset));
+        baseVertices.push_back(range.baseVertex);
+#ifdef VALIDATE_DRAW_RANGES
+        ranges.push_back(range);
+#endif
+        return true;
+    }
+
+    // drops every range, keeping the VAO
+    void clear()
+    {
+        indexType = 0;
+        counts.clear();
+        offsets.clear();
+        baseVertices.clear();
+#ifdef VALIDATE_DRAW_RANGES
+        ranges.clear();
+#endif
+    }
+};
+
+#ifdef VALIDATE_DRAW_RANGES
+inline GLint boundBufferSize(GLuint buffer)
+{
+    GLint size = 0;
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &size);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    return size;
+}
+
+// asserts that the range only touches vertices and indices that exist in the buffers
+// bound to the current VAO (attribute 0 decides the vertex buffer and its stride).
+// checkVAO also asserts the bound VAO is range.VAO; instanced draws go through VAOs
+// of their own that share the range's buffers, so they only check the bounds.
+inline void validateDrawRange(const DrawRange& range, bool checkVAO = true)
+{
+    GLint vao = 0;
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vao);
+    assert((!checkVAO || static_cast<unsigned int>(vao) == range.VAO) && "draw range used with a different VAO bound");
+
+    GLint vbo = 0, stride = 0, components = 0, type = 0;
+    glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &vbo);
+    glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &stride);
+    glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_SIZE, &components);
+    glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_TYPE, &type);
+    if (stride == 0)
+        stride = components * ((type == GL_SHORT || type == GL_UNSIGNED_SHORT) ? 2 : (type == GL_BYTE || type == GL_UNSIGNED_BYTE) ? 1 : 4);
+    assert(vbo != 0 && "VAO has no vertex buffer for attribute 0");
+    assert(range.count >= 0 && range.first >= 0 && range.baseVertex >= 0);
+    assert(static_cast<long long>(range.baseVertex + range.vertexCount) * stride <= boundBufferSize(vbo) && "draw range reads past the vertex buffer");
+
+    if (range.indexType != 0)
+    {
+        GLint ebo = 0, indexBytes = 0;
+        glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &ebo);
+        assert(ebo != 0 && "indexed draw range with no element buffer bound");
+        glGetBufferParameteriv(GL_ELEMENT_ARRAY_BUFFER, GL_BUFFER_SIZE, &indexBytes);
+        assert(range.indexOffset + static_cast<long long>(range.count) * indexTypeSize(range.indexType) <= indexBytes && "draw range reads past the element buffer");
+        assert((range.count == 0 || static_cast<GLsizei>(range.maxIndex) < range.vertexCount) && "index points past the range's vertices");
+    }
+    else
+        assert(range.first + range.count <= range.vertexCount);
+}
+#endif
+
+// issues the draw for a range, its VAO must be bound
+inline void drawRange(const DrawRange& range)
+{
+#ifdef VALIDATE_DRAW_RANGES
+    validateDrawRange(range);
+#endif
+    if (range.indexType != 0)
+        glDrawElementsBaseVertex(GL_TRIANGLES, range.count, range.indexType, reinterpret_cast<void*>(range.indexOffset), range.baseVertex);
+    else
+        glDrawArrays(GL_TRIANGLES, range.first, range.count);
+    frameStats.drawCalls++;
+}
+
+// draws instanceCount copies of a range with one call; the bound VAO must be one that
+// shares the range's buffers (range.VAO is not checked, instanced VAOs are separate)
+inline void drawRangeInstanced(const DrawRange& range, GLsizei instanceCount)
+{
+    if (instanceCount <= 0)
+        return;
+#ifdef VALIDATE_DRAW_RANGES
+    validateDrawRange(range, false);
+#endif
+    if (range.indexType != 0)
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES, range.count, range.indexType, reinterpret_cast<void*>(range.indexOffset),
+                                          instanceCount, range.baseVertex);
+    else
+        glDrawArraysInstanced(GL_TRIANGLES, range.first, range.count, instanceCount);
+    frameStats.drawCalls++;
+}
+
+// issues every range of the batch with one call, its VAO must be bound
+inline void drawBatch(const MultiDrawBatch& batch)
+{
+    if (batch.counts.empty())
+        return;
+#ifdef VALIDATE_DRAW_RANGES
+    for (const DrawRange& range : batch.ranges)
+        validateDrawRange(range);
+#endif
+    glMultiDrawElementsBaseVertex(GL_TRIANGLES, batch.counts.data(), batch.indexType, batch.offsets.data(),
+                                  static_cast<GLsizei>(batch.counts.size()), const_cast<GLint*>(batch.baseVertices.data()));
+    frameStats.drawCalls++;
+}
+#endif
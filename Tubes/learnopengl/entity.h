@@ -2,478 +2,524 @@
 #define ENTITY_H
 
 #include <glm/glm.hpp> //glm::mat4
-#include <list> //std::list
-#include <array> //std::array
-#include <memory> //std::unique_ptr
+#include <algorithm> //std::sort
+#include <cstdint> //uint32_t
+#include <limits> //std::numeric_limits
+#include <vector> //std::vector
 
-class Transform
-{
-protected:
-	//Local space information
-	glm::vec3 m_pos = { 0.0f, 0.0f, 0.0f };
-	glm::vec3 m_eulerRot = { 0.0f, 0.0f, 0.0f }; //In degrees
-	glm::vec3 m_scale = { 1.0f, 1.0f, 1.0f };
-
-	//Global space informaiton concatenate in matrix
-	glm::mat4 m_modelMatrix = glm::mat4(1.0f);
-
-	//Dirty flag
-	bool m_isDirty = true;
+#include <learnopengl/bounds_tree.h>
+#include <learnopengl/draw_queue.h>
+#include <learnopengl/frustum.h>
+#include <learnopengl/frustum_culler.h>
+#include <learnopengl/transform.h>
 
-protected:
-	glm::mat4 getLocalModelMatrix()
+AABB generateAABB(const Model& model)
+{
+	glm::vec3 minAABB = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 maxAABB = glm::vec3(std::numeric_limits<float>::min());
+	for (auto&& mesh : model.meshes)
 	{
-		const glm::mat4 transformX = glm::rotate(glm::mat4(1.0f), glm::radians(m_eulerRot.x), glm::vec3(1.0f, 0.0f, 0.0f));
-		const glm::mat4 transformY = glm::rotate(glm::mat4(1.0f), glm::radians(m_eulerRot.y), glm::vec3(0.0f, 1.0f, 0.0f));
-		const glm::mat4 transformZ = glm::rotate(glm::mat4(1.0f), glm::radians(m_eulerRot.z), glm::vec3(0.0f, 0.0f, 1.0f));
-
-		// Y * X * Z
-		const glm::mat4 roationMatrix = transformY * transformX * transformZ;
+		for (auto&& vertex : mesh.vertices)
+		{
+			minAABB.x = std::min(minAABB.x, vertex.Position.x);
+			minAABB.y = std::min(minAABB.y, vertex.Position.y);
+			minAABB.z = std::min(minAABB.z, vertex.Position.z);
 
-		// translation * rotation * scale (also know as TRS matrix)
-		return glm::translate(glm::mat4(1.0f), m_pos) * roationMatrix * glm::scale(glm::mat4(1.0f), m_scale);
+			maxAABB.x = std::max(maxAABB.x, vertex.Position.x);
+			maxAABB.y = std::max(maxAABB.y, vertex.Position.y);
+			maxAABB.z = std::max(maxAABB.z, vertex.Position.z);
+		}
 	}
-public:
+	return AABB(minAABB, maxAABB);
+}
 
-	void computeModelMatrix()
+Sphere generateSphereBV(const Model& model)
+{
+	glm::vec3 minAABB = glm::vec3(std::numeric_limits<float>::max());
+	glm::vec3 maxAABB = glm::vec3(std::numeric_limits<float>::min());
+	for (auto&& mesh : model.meshes)
 	{
-		m_modelMatrix = getLocalModelMatrix();
-	}
+		for (auto&& vertex : mesh.vertices)
+		{
+			minAABB.x = std::min(minAABB.x, vertex.Position.x);
+			minAABB.y = std::min(minAABB.y, vertex.Position.y);
+			minAABB.z = std::min(minAABB.z, vertex.Position.z);
 
-	void computeModelMatrix(const glm::mat4& parentGlobalModelMatrix)
-	{
-		m_modelMatrix = parentGlobalModelMatrix * getLocalModelMatrix();
+			maxAABB.x = std::max(maxAABB.x, vertex.Position.x);
+			maxAABB.y = std::max(maxAABB.y, vertex.Position.y);
+			maxAABB.z = std::max(maxAABB.z, vertex.Position.z);
+		}
 	}
 
-	void setLocalPosition(const glm::vec3& newPosition)
-	{
-		m_pos = newPosition;
-		m_isDirty = true;
+	return Sphere((maxAABB + minAABB) * 0.5f, glm::length(minAABB - maxAABB));
+}
+
+//Flat storage of a whole scene graph. Every node's data lives in parallel arrays indexed by slot, in depth-first
+//order: a parent always comes before its children and each subtree is one contiguous run of slots, so updating
+//world matrices is a single linear pass and a subtree is just a slot range. Nodes are named by a NodeId that
+//never changes; slots do, whenever nodes are reordered.
+//Changing a node queues it as a dirty root; an update recomputes the subtrees of the queued roots and nothing
+//else, so a scene where nothing moved costs nothing.
+//World bounds also go into a BoundsTree, built on the first query and refit by every update, which answers the
+//frustum, ray and overlap queries without visiting the nodes it can rule out.
+class SceneGraph
+{
+public:
+	typedef uint32_t NodeId;
+	static constexpr uint32_t NONE = 0xFFFFFFFFu;
+
+	//Adds a root node, or a child of parent, drawing model (may be null for a pure grouping node)
+	NodeId addNode(Model* model, const AABB& localBounds, NodeId parent = NONE)
+	{
+		const uint32_t parentSlot = parent == NONE ? NONE : m_slotOf[parent];
+		//Appending keeps the order as long as nothing follows the parent's subtree yet
+		if (parentSlot != NONE && parentSlot + m_subtreeSize[parentSlot] != size())
+			m_sorted = false;
+
+		const uint32_t slot = size();
+		const NodeId id = static_cast<NodeId>(m_slotOf.size());
+		m_slotOf.push_back(slot);
+		m_idAt.push_back(id);
+		m_parent.push_back(parentSlot);
+		m_subtreeSize.push_back(1);
+		m_local.push_back(LocalTransform{});
+		m_world.push_back(glm::mat4(1.0f));
+		m_localCenter.push_back(localBounds.center);
+		m_localExtents.push_back(localBounds.extents);
+		m_worldBounds.add(localBounds);
+		m_model.push_back(model);
+		m_pass.push_back(DRAW_PASS_OPAQUE);
+		m_dirty.push_back(0);
+		markDirty(id);
+		for (uint32_t ancestor = parentSlot; ancestor != NONE; ancestor = m_parent[ancestor])
+			m_subtreeSize[ancestor]++;
+		return id;
 	}
 
-	void setLocalRotation(const glm::vec3& newRotation)
+	uint32_t size() const
 	{
-		m_eulerRot = newRotation;
-		m_isDirty = true;
+		return static_cast<uint32_t>(m_idAt.size());
 	}
 
-	void setLocalScale(const glm::vec3& newScale)
+	//Recomputes the world matrix and bounds of every dirty node and everything below it
+	void update()
 	{
-		m_scale = newScale;
-		m_isDirty = true;
+		sortNodes();
+		updateDirtyRoots(0, size());
 	}
 
-	const glm::vec3& getGlobalPosition() const
+	//Same, for the dirty nodes in the subtree of node only; the others stay queued
+	void updateSubtree(NodeId node)
 	{
-		return m_modelMatrix[3];
+		sortNodes();
+		const uint32_t slot = m_slotOf[node];
+		updateDirtyRoots(slot, slot + m_subtreeSize[slot]);
 	}
 
-	const glm::vec3& getLocalPosition() const
+	//Nodes whose world matrix was recomputed by the last update
+	uint32_t recomputedNodes() const
 	{
-		return m_pos;
+		return m_recomputed;
 	}
 
-	const glm::vec3& getLocalRotation() const
+	//Slot of a node and the slots after it that make up its subtree, valid until the next addNode()
+	uint32_t slotOf(NodeId node)
 	{
-		return m_eulerRot;
+		sortNodes();
+		return m_slotOf[node];
 	}
 
-	const glm::vec3& getLocalScale() const
+	uint32_t subtreeSize(NodeId node) const
 	{
-		return m_scale;
+		return m_subtreeSize[m_slotOf[node]];
 	}
 
-	const glm::mat4& getModelMatrix() const
+	NodeId idAt(uint32_t slot) const
 	{
-		return m_modelMatrix;
+		return m_idAt[slot];
 	}
 
-	glm::vec3 getRight() const
+	NodeId parentOf(NodeId node) const
 	{
-		return m_modelMatrix[0];
+		const uint32_t parentSlot = m_parent[m_slotOf[node]];
+		return parentSlot == NONE ? NONE : m_idAt[parentSlot];
 	}
 
-
-	glm::vec3 getUp() const
+	std::vector<NodeId> childrenOf(NodeId node)
 	{
-		return m_modelMatrix[1];
+		std::vector<NodeId> children;
+		const uint32_t slot = slotOf(node);
+		for (uint32_t child = slot + 1; child < slot + m_subtreeSize[slot]; child += m_subtreeSize[child])
+			children.push_back(m_idAt[child]);
+		return children;
 	}
 
-	glm::vec3 getBackward() const
+	//Slots of the subtree of node whose world bounds are in the frustum, in slot order, valid until the next call
+	const std::vector<uint32_t>& cullSubtree(const Frustum& frustum, NodeId node)
 	{
-		return m_modelMatrix[2];
+		const uint32_t first = slotOf(node);
+		const uint32_t end = first + m_subtreeSize[first];
+		boundsTree().cullFrustum(frustum, m_treeResults);
+		m_visible.clear();
+		for (NodeId visible : m_treeResults)
+		{
+			const uint32_t slot = m_slotOf[visible];
+			if (slot >= first && slot < end)
+				m_visible.push_back(slot);
+		}
+		std::sort(m_visible.begin(), m_visible.end());
+		return m_visible;
 	}
 
-	glm::vec3 getForward() const
+	//Nodes whose world bounds the ray enters within maxDistance, nearest first
+	void raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, std::vector<BoundsTreeRayHit>& hits)
 	{
-		return -m_modelMatrix[2];
+		boundsTree().raycast(origin, direction, maxDistance, hits);
 	}
 
-	glm::vec3 getGlobalScale() const
+	//Nodes whose world bounds touch box
+	void overlap(const AABB& box, std::vector<NodeId>& nodes)
 	{
-		return { glm::length(getRight()), glm::length(getUp()), glm::length(getBackward()) };
+		boundsTree().overlap(box.center - box.extents, box.center + box.extents, nodes);
 	}
 
-	bool isDirty() const
+	//The tree over the world bounds as of the last update, built or rebuilt if it has to be
+	BoundsTree& boundsTree()
 	{
-		return m_isDirty;
+		if (!m_treeBuilt)
+		{
+			std::vector<BoundsTreeItem> items;
+			items.reserve(size());
+			for (uint32_t slot = 0; slot < size(); slot++)
+				items.push_back({ m_idAt[slot], worldMin(slot), worldMax(slot) });
+			m_tree.build(items);
+			m_treeBuilt = true;
+		}
+		else if (m_tree.needsRebuild())
+			m_tree.rebuild();
+		return m_tree;
 	}
-};
-
-struct Plan
-{
-	glm::vec3 normal = { 0.f, 1.f, 0.f }; // unit vector
-	float     distance = 0.f;        // Distance with origin
-
-	Plan() = default;
-
-	Plan(const glm::vec3& p1, const glm::vec3& norm)
-		: normal(glm::normalize(norm)),
-		distance(glm::dot(normal, p1))
-	{}
 
-	float getSignedDistanceToPlan(const glm::vec3& point) const
+	//Per node data; changing the local transform marks the node dirty
+	const LocalTransform& getLocal(NodeId node) const { return m_local[m_slotOf[node]]; }
+	LocalTransform& editLocal(NodeId node)
 	{
-		return glm::dot(normal, point) - distance;
+		markDirty(node);
+		return m_local[m_slotOf[node]];
 	}
-};
-
-struct Frustum
-{
-	Plan topFace;
-	Plan bottomFace;
-
-	Plan rightFace;
-	Plan leftFace;
-
-	Plan farFace;
-	Plan nearFace;
-};
-
-struct BoundingVolume
-{
-	virtual bool isOnFrustum(const Frustum& camFrustum, const Transform& transform) const = 0;
-
-	virtual bool isOnOrForwardPlan(const Plan& plan) const = 0;
-
-	bool isOnFrustum(const Frustum& camFrustum) const
+	bool isDirty(NodeId node) const { return m_dirty[m_slotOf[node]] != 0; }
+	void markDirty(NodeId node)
 	{
-		return (isOnOrForwardPlan(camFrustum.leftFace) &&
-			isOnOrForwardPlan(camFrustum.rightFace) &&
-			isOnOrForwardPlan(camFrustum.topFace) &&
-			isOnOrForwardPlan(camFrustum.bottomFace) &&
-			isOnOrForwardPlan(camFrustum.nearFace) &&
-			isOnOrForwardPlan(camFrustum.farFace));
-	};
-};
-
-struct Sphere : public BoundingVolume
-{
-	glm::vec3 center{ 0.f, 0.f, 0.f };
-	float radius{ 0.f };
-
-	Sphere(const glm::vec3& inCenter, float inRadius)
-		: BoundingVolume{}, center{ inCenter }, radius{ inRadius }
-	{}
-
-	bool isOnOrForwardPlan(const Plan& plan) const final
+		uint8_t& dirty = m_dirty[m_slotOf[node]];
+		if (!dirty)
+			m_dirtyRoots.push_back(node);
+		dirty = 1;
+	}
+	const glm::mat4& getWorld(NodeId node) const { return m_world[m_slotOf[node]]; }
+	AABB getLocalAABB(NodeId node) const
 	{
-		return plan.getSignedDistanceToPlan(center) > -radius;
+		const uint32_t slot = m_slotOf[node];
+		return AABB(m_localCenter[slot], m_localExtents[slot].x, m_localExtents[slot].y, m_localExtents[slot].z);
 	}
-
-	bool isOnFrustum(const Frustum& camFrustum, const Transform& transform) const final
+	AABB getWorldAABB(NodeId node) const
 	{
-		//Get global scale thanks to our transform
-		const glm::vec3 globalScale = transform.getGlobalScale();
-
-		//Get our global center with process it with the global model matrix of our transform
-		const glm::vec3 globalCenter{ transform.getModelMatrix() * glm::vec4(center, 1.f) };
-
-		//To wrap correctly our shape, we need the maximum scale scalar.
-		const float maxScale = std::max(std::max(globalScale.x, globalScale.y), globalScale.z);
-
-		//Max scale is assuming for the diameter. So, we need the half to apply it to our radius
-		Sphere globalSphere(globalCenter, radius * (maxScale * 0.5f));
-
-		//Check Firstly the result that have the most chance to faillure to avoid to call all functions.
-		return (globalSphere.isOnOrForwardPlan(camFrustum.leftFace) &&
-			globalSphere.isOnOrForwardPlan(camFrustum.rightFace) &&
-			globalSphere.isOnOrForwardPlan(camFrustum.farFace) &&
-			globalSphere.isOnOrForwardPlan(camFrustum.nearFace) &&
-			globalSphere.isOnOrForwardPlan(camFrustum.topFace) &&
-			globalSphere.isOnOrForwardPlan(camFrustum.bottomFace));
-	};
-};
-
-struct SquareAABB : public BoundingVolume
-{
-	glm::vec3 center{ 0.f, 0.f, 0.f };
-	float extent{ 0.f };
-
-	SquareAABB(const glm::vec3& inCenter, float inExtent)
-		: BoundingVolume{}, center{ inCenter }, extent{ inExtent }
-	{}
+		const uint32_t slot = m_slotOf[node];
+		return AABB(glm::vec3(m_worldBounds.centerX[slot], m_worldBounds.centerY[slot], m_worldBounds.centerZ[slot]),
+			m_worldBounds.extentX[slot], m_worldBounds.extentY[slot], m_worldBounds.extentZ[slot]);
+	}
+	Model* getModel(NodeId node) const { return m_model[m_slotOf[node]]; }
+	DrawPass getPass(NodeId node) const { return m_pass[m_slotOf[node]]; }
+	void setPass(NodeId node, DrawPass pass) { m_pass[m_slotOf[node]] = pass; }
+
+	//Slot indexed arrays, for passes over the whole scene (slots are in depth-first order after update())
+	const std::vector<glm::mat4>& worldMatrices() const { return m_world; }
+	const CullingBounds& worldBounds() const { return m_worldBounds; }
+	const std::vector<Model*>& models() const { return m_model; }
+	const std::vector<DrawPass>& passes() const { return m_pass; }
+
+private:
+	//indexed by NodeId
+	std::vector<uint32_t> m_slotOf;
+
+	//indexed by slot
+	std::vector<NodeId> m_idAt;
+	std::vector<uint32_t> m_parent; //slot of the parent, NONE for roots
+	std::vector<uint32_t> m_subtreeSize; //the node and all its descendants
+	std::vector<LocalTransform> m_local;
+	std::vector<glm::mat4> m_world;
+	std::vector<glm::vec3> m_localCenter;
+	std::vector<glm::vec3> m_localExtents;
+	CullingBounds m_worldBounds;
+	std::vector<Model*> m_model;
+	std::vector<DrawPass> m_pass;
+	std::vector<uint8_t> m_dirty; //changed since the last update, also set on every node in m_dirtyRoots
+
+	std::vector<NodeId> m_dirtyRoots; //nodes changed since the last update, each queued once
+	std::vector<uint32_t> m_dirtySlots;
+	uint32_t m_recomputed = 0;
+
+	BoundsTree m_tree;
+	bool m_treeBuilt = false;
+	std::vector<uint32_t> m_treeResults;
+
+	std::vector<uint32_t> m_visible;
+	bool m_sorted = true;
+
+	glm::vec3 worldMin(uint32_t slot) const
+	{
+		return glm::vec3(m_worldBounds.centerX[slot] - m_worldBounds.extentX[slot], m_worldBounds.centerY[slot] - m_worldBounds.extentY[slot],
+			m_worldBounds.centerZ[slot] - m_worldBounds.extentZ[slot]);
+	}
 
-	bool isOnOrForwardPlan(const Plan& plan) const final
+	glm::vec3 worldMax(uint32_t slot) const
 	{
-		// Compute the projection interval radius of b onto L(t) = b.c + t * p.n
-		const float r = extent * (std::abs(plan.normal.x) + std::abs(plan.normal.y) + std::abs(plan.normal.z));
-		return -r <= plan.getSignedDistanceToPlan(center);
+		return glm::vec3(m_worldBounds.centerX[slot] + m_worldBounds.extentX[slot], m_worldBounds.centerY[slot] + m_worldBounds.extentY[slot],
+			m_worldBounds.centerZ[slot] + m_worldBounds.extentZ[slot]);
 	}
 
-	bool isOnFrustum(const Frustum& camFrustum, const Transform& transform) const final
+	//Recomputes the subtree of every queued node with a slot in [first, end). Slots go in increasing order, so a
+	//queued node below one already recomputed is skipped, its subtree was part of that one
+	void updateDirtyRoots(uint32_t first, uint32_t end)
 	{
-		//Get global scale thanks to our transform
-		const glm::vec3 globalCenter{ transform.getModelMatrix() * glm::vec4(center, 1.f) };
-
-		// Scaled orientation
-		const glm::vec3 right = transform.getRight() * extent;
-		const glm::vec3 up = transform.getUp() * extent;
-		const glm::vec3 forward = transform.getForward() * extent;
-
-		const float newIi = std::abs(glm::dot(glm::vec3{ 1.f, 0.f, 0.f }, right)) +
-			std::abs(glm::dot(glm::vec3{ 1.f, 0.f, 0.f }, up)) +
-			std::abs(glm::dot(glm::vec3{ 1.f, 0.f, 0.f }, forward));
-
-		const float newIj = std::abs(glm::dot(glm::vec3{ 0.f, 1.f, 0.f }, right)) +
-			std::abs(glm::dot(glm::vec3{ 0.f, 1.f, 0.f }, up)) +
-			std::abs(glm::dot(glm::vec3{ 0.f, 1.f, 0.f }, forward));
-
-		const float newIk = std::abs(glm::dot(glm::vec3{ 0.f, 0.f, 1.f }, right)) +
-			std::abs(glm::dot(glm::vec3{ 0.f, 0.f, 1.f }, up)) +
-			std::abs(glm::dot(glm::vec3{ 0.f, 0.f, 1.f }, forward));
-
-		const SquareAABB globalAABB(globalCenter, std::max(std::max(newIi, newIj), newIk));
-
-		return (globalAABB.isOnOrForwardPlan(camFrustum.leftFace) &&
-			globalAABB.isOnOrForwardPlan(camFrustum.rightFace) &&
-			globalAABB.isOnOrForwardPlan(camFrustum.topFace) &&
-			globalAABB.isOnOrForwardPlan(camFrustum.bottomFace) &&
-			globalAABB.isOnOrForwardPlan(camFrustum.nearFace) &&
-			globalAABB.isOnOrForwardPlan(camFrustum.farFace));
-	};
-};
-
-struct AABB : public BoundingVolume
-{
-	glm::vec3 center{ 0.f, 0.f, 0.f };
-	glm::vec3 extents{ 0.f, 0.f, 0.f };
-
-	AABB(const glm::vec3& min, const glm::vec3& max)
-		: BoundingVolume{}, center{ (max + min) * 0.5f }, extents{ max.x - center.x, max.y - center.y, max.z - center.z }
-	{}
-
-	AABB(const glm::vec3& inCenter, float iI, float iJ, float iK)
-		: BoundingVolume{}, center{ inCenter }, extents{ iI, iJ, iK }
-	{}
+		m_recomputed = 0;
+		m_dirtySlots.clear();
+		size_t kept = 0;
+		for (NodeId node : m_dirtyRoots)
+		{
+			const uint32_t slot = m_slotOf[node];
+			if (slot >= first && slot < end)
+				m_dirtySlots.push_back(slot);
+			else
+				m_dirtyRoots[kept++] = node;
+		}
+		m_dirtyRoots.resize(kept);
+		std::sort(m_dirtySlots.begin(), m_dirtySlots.end());
 
-	std::array<glm::vec3, 8> getVertice() const
-	{
-		std::array<glm::vec3, 8> vertice;
-		vertice[0] = { center.x - extents.x, center.y - extents.y, center.z - extents.z };
-		vertice[1] = { center.x + extents.x, center.y - extents.y, center.z - extents.z };
-		vertice[2] = { center.x - extents.x, center.y + extents.y, center.z - extents.z };
-		vertice[3] = { center.x + extents.x, center.y + extents.y, center.z - extents.z };
-		vertice[4] = { center.x - extents.x, center.y - extents.y, center.z + extents.z };
-		vertice[5] = { center.x + extents.x, center.y - extents.y, center.z + extents.z };
-		vertice[6] = { center.x - extents.x, center.y + extents.y, center.z + extents.z };
-		vertice[7] = { center.x + extents.x, center.y + extents.y, center.z + extents.z };
-		return vertice;
+		uint32_t recomputedEnd = 0;
+		for (uint32_t root : m_dirtySlots)
+		{
+			if (root < recomputedEnd)
+				continue;
+			recomputedEnd = root + m_subtreeSize[root];
+			for (uint32_t slot = root; slot < recomputedEnd; slot++)
+			{
+				const uint32_t parent = m_parent[slot];
+				m_world[slot] = parent == NONE ? m_local[slot].getMatrix() : m_world[parent] * m_local[slot].getMatrix();
+				const AABB local(m_localCenter[slot], m_localExtents[slot].x, m_localExtents[slot].y, m_localExtents[slot].z);
+				m_worldBounds.set(slot, local.transformed(m_world[slot]));
+				if (m_treeBuilt)
+					m_tree.update(m_idAt[slot], worldMin(slot), worldMax(slot));
+				m_dirty[slot] = 0;
+			}
+			m_recomputed += recomputedEnd - root;
+		}
+		frameStats.transformUpdates += m_recomputed;
 	}
 
-	//see https://gdbooks.gitbooks.io/3dcollisions/content/Chapter2/static_aabb_plan.html
-	bool isOnOrForwardPlan(const Plan& plan) const final
+	template<typename T>
+	static void permute(std::vector<T>& values, const std::vector<uint32_t>& order)
 	{
-		// Compute the projection interval radius of b onto L(t) = b.c + t * p.n
-		const float r = extents.x * std::abs(plan.normal.x) + extents.y * std::abs(plan.normal.y) +
-			extents.z * std::abs(plan.normal.z);
-
-		return -r <= plan.getSignedDistanceToPlan(center);
+		std::vector<T> sorted;
+		sorted.reserve(values.size());
+		for (uint32_t slot : order)
+			sorted.push_back(values[slot]);
+		values.swap(sorted);
 	}
 
-	bool isOnFrustum(const Frustum& camFrustum, const Transform& transform) const final
+	//Puts the slots back in depth-first order after children were added to nodes whose subtree wasn't last
+	void sortNodes()
 	{
-		//Get global scale thanks to our transform
-		const glm::vec3 globalCenter{ transform.getModelMatrix() * glm::vec4(center, 1.f) };
-
-		// Scaled orientation
-		const glm::vec3 right = transform.getRight() * extents.x;
-		const glm::vec3 up = transform.getUp() * extents.y;
-		const glm::vec3 forward = transform.getForward() * extents.z;
-
-		const float newIi = std::abs(glm::dot(glm::vec3{ 1.f, 0.f, 0.f }, right)) +
-			std::abs(glm::dot(glm::vec3{ 1.f, 0.f, 0.f }, up)) +
-			std::abs(glm::dot(glm::vec3{ 1.f, 0.f, 0.f }, forward));
-
-		const float newIj = std::abs(glm::dot(glm::vec3{ 0.f, 1.f, 0.f }, right)) +
-			std::abs(glm::dot(glm::vec3{ 0.f, 1.f, 0.f }, up)) +
-			std::abs(glm::dot(glm::vec3{ 0.f, 1.f, 0.f }, forward));
-
-		const float newIk = std::abs(glm::dot(glm::vec3{ 0.f, 0.f, 1.f }, right)) +
-			std::abs(glm::dot(glm::vec3{ 0.f, 0.f, 1.f }, up)) +
-			std::abs(glm::dot(glm::vec3{ 0.f, 0.f, 1.f }, forward));
-
-		const AABB globalAABB(globalCenter, newIi, newIj, newIk);
-
-		return (globalAABB.isOnOrForwardPlan(camFrustum.leftFace) &&
-			globalAABB.isOnOrForwardPlan(camFrustum.rightFace) &&
-			globalAABB.isOnOrForwardPlan(camFrustum.topFace) &&
-			globalAABB.isOnOrForwardPlan(camFrustum.bottomFace) &&
-			globalAABB.isOnOrForwardPlan(camFrustum.nearFace) &&
-			globalAABB.isOnOrForwardPlan(camFrustum.farFace));
-	};
-};
-
-Frustum createFrustumFromCamera(const Camera& cam, float aspect, float fovY, float zNear, float zFar)
-{
-	Frustum     frustum;
-	const float halfVSide = zFar * tanf(fovY * .5f);
-	const float halfHSide = halfVSide * aspect;
-	const glm::vec3 frontMultFar = zFar * cam.Front;
-
-	frustum.nearFace = { cam.Position + zNear * cam.Front, cam.Front };
-	frustum.farFace = { cam.Position + frontMultFar, -cam.Front };
-	frustum.rightFace = { cam.Position, glm::cross(cam.Up, frontMultFar + cam.Right * halfHSide) };
-	frustum.leftFace = { cam.Position, glm::cross(frontMultFar - cam.Right * halfHSide, cam.Up) };
-	frustum.topFace = { cam.Position, glm::cross(cam.Right, frontMultFar - cam.Up * halfVSide) };
-	frustum.bottomFace = { cam.Position, glm::cross(frontMultFar + cam.Up * halfVSide, cam.Right) };
-
-	return frustum;
-}
+		if (m_sorted)
+			return;
+		const uint32_t count = size();
 
-AABB generateAABB(const Model& model)
-{
-	glm::vec3 minAABB = glm::vec3(std::numeric_limits<float>::max());
-	glm::vec3 maxAABB = glm::vec3(std::numeric_limits<float>::min());
-	for (auto&& mesh : model.meshes)
-	{
-		for (auto&& vertex : mesh.vertices)
+		//children of every slot, in slot order
+		std::vector<uint32_t> childStart(count + 1, 0), children(count);
+		for (uint32_t slot = 0; slot < count; slot++)
 		{
-			minAABB.x = std::min(minAABB.x, vertex.Position.x);
-			minAABB.y = std::min(minAABB.y, vertex.Position.y);
-			minAABB.z = std::min(minAABB.z, vertex.Position.z);
-
-			maxAABB.x = std::max(maxAABB.x, vertex.Position.x);
-			maxAABB.y = std::max(maxAABB.y, vertex.Position.y);
-			maxAABB.z = std::max(maxAABB.z, vertex.Position.z);
+			if (m_parent[slot] != NONE)
+				childStart[m_parent[slot] + 1]++;
+		}
+		for (uint32_t slot = 0; slot < count; slot++)
+			childStart[slot + 1] += childStart[slot];
+		std::vector<uint32_t> cursor(childStart.begin(), childStart.end() - 1);
+		for (uint32_t slot = 0; slot < count; slot++)
+		{
+			if (m_parent[slot] != NONE)
+				children[cursor[m_parent[slot]]++] = slot;
 		}
-	}
-	return AABB(minAABB, maxAABB);
-}
 
-Sphere generateSphereBV(const Model& model)
-{
-	glm::vec3 minAABB = glm::vec3(std::numeric_limits<float>::max());
-	glm::vec3 maxAABB = glm::vec3(std::numeric_limits<float>::min());
-	for (auto&& mesh : model.meshes)
-	{
-		for (auto&& vertex : mesh.vertices)
+		//depth-first walk from every root, children pushed in reverse so they come out in order
+		std::vector<uint32_t> order, stack;
+		order.reserve(count);
+		for (uint32_t root = 0; root < count; root++)
 		{
-			minAABB.x = std::min(minAABB.x, vertex.Position.x);
-			minAABB.y = std::min(minAABB.y, vertex.Position.y);
-			minAABB.z = std::min(minAABB.z, vertex.Position.z);
+			if (m_parent[root] != NONE)
+				continue;
+			stack.push_back(root);
+			while (!stack.empty())
+			{
+				const uint32_t slot = stack.back();
+				stack.pop_back();
+				order.push_back(slot);
+				for (uint32_t child = childStart[slot + 1]; child > childStart[slot]; child--)
+					stack.push_back(children[child - 1]);
+			}
+		}
 
-			maxAABB.x = std::max(maxAABB.x, vertex.Position.x);
-			maxAABB.y = std::max(maxAABB.y, vertex.Position.y);
-			maxAABB.z = std::max(maxAABB.z, vertex.Position.z);
+		std::vector<uint32_t> newSlot(count);
+		for (uint32_t slot = 0; slot < count; slot++)
+			newSlot[order[slot]] = slot;
+		for (uint32_t& parent : m_parent)
+		{
+			if (parent != NONE)
+				parent = newSlot[parent];
 		}
+		permute(m_idAt, order);
+		permute(m_parent, order);
+		permute(m_subtreeSize, order);
+		permute(m_local, order);
+		permute(m_world, order);
+		permute(m_localCenter, order);
+		permute(m_localExtents, order);
+		permute(m_worldBounds.centerX, order);
+		permute(m_worldBounds.centerY, order);
+		permute(m_worldBounds.centerZ, order);
+		permute(m_worldBounds.extentX, order);
+		permute(m_worldBounds.extentY, order);
+		permute(m_worldBounds.extentZ, order);
+		permute(m_model, order);
+		permute(m_pass, order);
+		permute(m_dirty, order);
+		for (uint32_t slot = 0; slot < count; slot++)
+			m_slotOf[m_idAt[slot]] = slot;
+		m_sorted = true;
 	}
+};
 
-	return Sphere((maxAABB + minAABB) * 0.5f, glm::length(minAABB - maxAABB));
-}
+//Transform of one scene graph node, with Transform's interface; the world matrix is the scene's to compute
+class EntityTransform
+{
+public:
+	EntityTransform() = default;
+	EntityTransform(SceneGraph* scene, SceneGraph::NodeId node) : m_scene{ scene }, m_node{ node } {}
+
+	void setLocalPosition(const glm::vec3& newPosition) { m_scene->editLocal(m_node).pos = newPosition; }
+	void setLocalRotation(const glm::vec3& newRotation) { m_scene->editLocal(m_node).eulerRot = newRotation; }
+	void setLocalScale(const glm::vec3& newScale) { m_scene->editLocal(m_node).scale = newScale; }
+
+	const glm::vec3& getLocalPosition() const { return m_scene->getLocal(m_node).pos; }
+	const glm::vec3& getLocalRotation() const { return m_scene->getLocal(m_node).eulerRot; }
+	const glm::vec3& getLocalScale() const { return m_scene->getLocal(m_node).scale; }
+
+	const glm::mat4& getModelMatrix() const { return m_scene->getWorld(m_node); }
+	glm::vec3 getGlobalPosition() const { return getModelMatrix()[3]; }
+	glm::vec3 getRight() const { return getModelMatrix()[0]; }
+	glm::vec3 getUp() const { return getModelMatrix()[1]; }
+	glm::vec3 getBackward() const { return getModelMatrix()[2]; }
+	glm::vec3 getForward() const { return -getModelMatrix()[2]; }
+	glm::vec3 getGlobalScale() const { return { glm::length(getRight()), glm::length(getUp()), glm::length(getBackward()) }; }
+
+	bool isDirty() const { return m_scene->isDirty(m_node); }
+
+private:
+	SceneGraph* m_scene = nullptr;
+	SceneGraph::NodeId m_node = SceneGraph::NONE;
+};
 
+//Handle to one node of a SceneGraph. Cheap to copy; the scene owns the data.
 class Entity
 {
 public:
-	//Scene graph
-	std::list<std::unique_ptr<Entity>> children;
-	Entity* parent = nullptr;
-
 	//Space information
-	Transform transform;
+	EntityTransform transform;
 
-	Model* pModel = nullptr;
-	std::unique_ptr<AABB> boundingVolume;
+	Entity() = default;
 
+	Entity(SceneGraph& scene, SceneGraph::NodeId node) : transform{ &scene, node }, m_scene{ &scene }, m_node{ node } {}
 
-	// constructor, expects a filepath to a 3D model.
-	Entity(Model& model) : pModel{ &model }
-	{
-		boundingVolume = std::make_unique<AABB>(generateAABB(model));
-		//boundingVolume = std::make_unique<Sphere>(generateSphereBV(model));
-	}
+	//New root entity in scene, expects a loaded model.
+	Entity(SceneGraph& scene, Model& model) : Entity(scene, scene.addNode(&model, generateAABB(model))) {}
 
-	AABB getGlobalAABB()
-	{
-		//Get global scale thanks to our transform
-		const glm::vec3 globalCenter{ transform.getModelMatrix() * glm::vec4(boundingVolume->center, 1.f) };
+	bool isValid() const { return m_scene != nullptr; }
+	SceneGraph::NodeId getNode() const { return m_node; }
 
-		// Scaled orientation
-		const glm::vec3 right = transform.getRight() * boundingVolume->extents.x;
-		const glm::vec3 up = transform.getUp() * boundingVolume->extents.y;
-		const glm::vec3 forward = transform.getForward() * boundingVolume->extents.z;
+	Model* getModel() const { return m_scene->getModel(m_node); }
+	AABB getLocalAABB() const { return m_scene->getLocalAABB(m_node); }
 
-		const float newIi = std::abs(glm::dot(glm::vec3{ 1.f, 0.f, 0.f }, right)) +
-			std::abs(glm::dot(glm::vec3{ 1.f, 0.f, 0.f }, up)) +
-			std::abs(glm::dot(glm::vec3{ 1.f, 0.f, 0.f }, forward));
+	//Opaque entities are sorted by state then front to back, transparent ones back to front
+	DrawPass getPass() const { return m_scene->getPass(m_node); }
+	void setPass(DrawPass pass) { m_scene->setPass(m_node, pass); }
 
-		const float newIj = std::abs(glm::dot(glm::vec3{ 0.f, 1.f, 0.f }, right)) +
-			std::abs(glm::dot(glm::vec3{ 0.f, 1.f, 0.f }, up)) +
-			std::abs(glm::dot(glm::vec3{ 0.f, 1.f, 0.f }, forward));
+	AABB getGlobalAABB() const
+	{
+		return m_scene->getWorldAABB(m_node);
+	}
 
-		const float newIk = std::abs(glm::dot(glm::vec3{ 0.f, 0.f, 1.f }, right)) +
-			std::abs(glm::dot(glm::vec3{ 0.f, 0.f, 1.f }, up)) +
-			std::abs(glm::dot(glm::vec3{ 0.f, 0.f, 1.f }, forward));
+	Entity getParent() const
+	{
+		const SceneGraph::NodeId parent = m_scene->parentOf(m_node);
+		return parent == SceneGraph::NONE ? Entity() : Entity(*m_scene, parent);
+	}
 
-		return AABB(globalCenter, newIi, newIj, newIk);
+	std::vector<Entity> getChildren() const
+	{
+		std::vector<Entity> children;
+		for (SceneGraph::NodeId child : m_scene->childrenOf(m_node))
+			children.push_back(Entity(*m_scene, child));
+		return children;
 	}
 
-	//Add child. Argument input is argument of any constructor that you create. By default you can use the default constructor and don't put argument input.
-	template<typename... TArgs>
-	void addChild(TArgs&... args)
+	//Add child drawing model, returns it
+	Entity addChild(Model& model)
 	{
-		children.emplace_back(std::make_unique<Entity>(args...));
-		children.back()->parent = this;
+		return Entity(*m_scene, m_scene->addNode(&model, generateAABB(model), m_node));
 	}
 
-	//Update transform if it was changed
+	//Update transforms that were changed, here and below
 	void updateSelfAndChild()
 	{
-		if (!transform.isDirty())
-			return;
-
-		forceUpdateSelfAndChild();
+		m_scene->updateSubtree(m_node);
 	}
 
 	//Force update of transform even if local space don't change
 	void forceUpdateSelfAndChild()
 	{
-		if (parent)
-			transform.computeModelMatrix(parent->transform.getModelMatrix());
-		else
-			transform.computeModelMatrix();
-
-		for (auto&& child : children)
-		{
-			child->forceUpdateSelfAndChild();
-		}
+		m_scene->markDirty(m_node);
+		m_scene->updateSubtree(m_node);
 	}
 
-
-	void drawSelfAndChild(const Frustum& frustum, Shader& ourShader, unsigned int& display, unsigned int& total)
+	//Add a draw packet for every mesh of the visible entities to the queue, in scene graph order
+	void collectSelfAndChild(const Frustum& frustum, Shader& ourShader, DrawQueue& queue, unsigned int& display, unsigned int& total)
 	{
-		if (boundingVolume->isOnFrustum(frustum, transform))
+		const std::vector<uint32_t>& visible = m_scene->cullSubtree(frustum, m_node);
+		const CullingBounds& bounds = m_scene->worldBounds();
+		for (uint32_t slot : visible)
 		{
-			ourShader.setMat4("model", transform.getModelMatrix());
-			pModel->Draw(ourShader);
-			display++;
+			Model* model = m_scene->models()[slot];
+			if (!model)
+				continue;
+			const glm::vec3 center(bounds.centerX[slot], bounds.centerY[slot], bounds.centerZ[slot]);
+			for (auto&& mesh : model->meshes)
+			{
+				queue.add(m_scene->passes()[slot], ourShader, mesh, m_scene->worldMatrices()[slot], center);
+			}
 		}
-		total++;
+		display += static_cast<unsigned int>(visible.size());
+		total += m_scene->subtreeSize(m_node);
+	}
 
-		for (auto&& child : children)
-		{
-			child->drawSelfAndChild(frustum, ourShader, display, total);
-		}
+	//Draw the visible entities sorted by their draw keys instead of in scene graph order, see queue.stats() for the state changes it saved
+	void drawSelfAndChild(const Frustum& frustum, Shader& ourShader, DrawQueue& queue, unsigned int& display, unsigned int& total)
+	{
+		//Depth is measured from the near plane and spans the near to far distance
+		queue.begin(frustum.nearFace.normal, frustum.nearFace.distance, -(frustum.nearFace.distance + frustum.farFace.distance));
+		collectSelfAndChild(frustum, ourShader, queue, display, total);
+		queue.submit();
 	}
+
+private:
+	SceneGraph* m_scene = nullptr;
+	SceneGraph::NodeId m_node = SceneGraph::NONE;
 };
 #endif
@@ -0,0 +1,73 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <iostream>
+
+// Per-frame counters for the render loop. Call endFrame() once per frame; once a
+// second the averages of the last second are written as one log line.
+struct FrameStats {
+    // counted this frame
+    unsigned int drawCalls = 0;
+    unsigned int vaoBinds = 0;
+    unsigned int uniformUploads = 0;
+    unsigned int stateCalls = 0;            // state changes that reached GL (see gl_state.h)
+    unsigned int stateCallsFiltered = 0;    // redundant ones glState dropped
+    unsigned int objectsVisible = 0;        // frustum culled objects that passed the test
+    unsigned int objectsTested = 0;         // and all of them, visible or not
+    unsigned int objectsOccluded = 0;       // in the frustum but hidden behind occluders
+    unsigned int transformUpdates = 0;      // scene graph nodes whose world matrix was recomputed
+
+    void endFrame(double now)
+    {
+        m_frames++;
+        m_drawCalls += drawCalls;
+        m_vaoBinds += vaoBinds;
+        m_uniformUploads += uniformUploads;
+        m_stateCalls += stateCalls;
+        m_stateCallsFiltered += stateCallsFiltered;
+        m_objectsVisible += objectsVisible;
+        m_objectsTested += objectsTested;
+        m_objectsOccluded += objectsOccluded;
+        m_transformUpdates += transformUpdates;
+        drawCalls = vaoBinds = uniformUploads = stateCalls = stateCallsFiltered = 0;
+        objectsVisible = objectsTested = objectsOccluded = transformUpdates = 0;
+
+        if (m_reportTime == 0.0)
+            m_reportTime = now;
+        if (now - m_reportTime < 1.0)
+            return;
+
+        std::cout << "frame: " << m_frames / (now - m_reportTime) << " fps, "
+                  << m_drawCalls / m_frames << " draw calls, "
+                  << m_vaoBinds / m_frames << " VAO binds, "
+                  << m_uniformUploads / m_frames << " uniform uploads, "
+                  << m_stateCalls / m_frames << " state calls (" << m_stateCallsFiltered / m_frames << " filtered)";
+        if (m_objectsTested > 0)
+            std::cout << ", " << m_objectsVisible / m_frames << "/" << m_objectsTested / m_frames << " objects visible";
+        if (m_objectsOccluded > 0)
+            std::cout << " (" << m_objectsOccluded / m_frames << " occluded)";
+        if (m_transformUpdates > 0)
+            std::cout << ", " << m_transformUpdates / m_frames << " transform updates";
+        std::cout << std::endl;
+        m_frames = 0;
+        m_drawCalls = m_vaoBinds = m_uniformUploads = m_stateCalls = m_stateCallsFiltered = 0;
+        m_objectsVisible = m_objectsTested = m_objectsOccluded = m_transformUpdates = 0;
+        m_reportTime = now;
+    }
+
+private:
+    unsigned long long m_frames = 0;
+    unsigned long long m_drawCalls = 0;
+    unsigned long long m_vaoBinds = 0;
+    unsigned long long m_uniformUploads = 0;
+    unsigned long long m_stateCalls = 0;
+    unsigned long long m_stateCallsFiltered = 0;
+    unsigned long long m_objectsVisible = 0;
+    unsigned long long m_objectsTested = 0;
+    unsigned long long m_objectsOccluded = 0;
+    unsigned long long m_transformUpdates = 0;
+    double m_reportTime = 0.0;
+};
+
+inline FrameStats frameStats;
+#endif
@@ -0,0 +1,194 @@
+#ifndef FRUSTUM_CULLER_H
+#define FRUSTUM_CULLER_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/frustum.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// SSE is always there on x86-64 (and 32-bit builds with -msse); -mavx or /arch:AVX
+// switches to 8 boxes per step. Anything else takes the scalar loop.
+#if defined(__AVX__)
+#define FRUSTUM_CULLER_AVX
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FRUSTUM_CULLER_SSE
+#include <xmmintrin.h>
+#endif
+
+// World space AABBs as a structure of arrays, one array per center and extent
+// component, so the culler loads the same component of 4 or 8 boxes at once.
+// Indices are whatever the caller adds them as; keep them in step with the objects.
+class CullingBounds
+{
+public:
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+
+    size_t size() const
+    {
+        return centerX.size();
+    }
+
+    void clear()
+    {
+        resize(0);
+    }
+
+    void resize(size_t count)
+    {
+        centerX.resize(count);
+        centerY.resize(count);
+        centerZ.resize(count);
+        extentX.resize(count);
+        extentY.resize(count);
+        extentZ.resize(count);
+    }
+
+    // appends a box, returns its index
+    uint32_t add(const AABB& box)
+    {
+        resize(size() + 1);
+        set(static_cast<uint32_t>(size() - 1), box);
+        return static_cast<uint32_t>(size() - 1);
+    }
+
+    void set(uint32_t index, const AABB& box)
+    {
+        centerX[index] = box.center.x;
+        centerY[index] = box.center.y;
+        centerZ[index] = box.center.z;
+        extentX[index] = box.extents.x;
+        extentY[index] = box.extents.y;
+        extentZ[index] = box.extents.z;
+    }
+};
+
+// The six planes of a frustum, split into components: normal, |normal| (for the
+// box's projected radius) and distance.
+struct CullingPlanes {
+    float normalX[6], normalY[6], normalZ[6];
+    float absX[6], absY[6], absZ[6];
+    float distance[6];
+
+    explicit CullingPlanes(const Frustum& frustum)
+    {
+        const Plan* planes[6] = { &frustum.leftFace, &frustum.rightFace, &frustum.topFace,
+                                  &frustum.bottomFace, &frustum.nearFace, &frustum.farFace };
+        for (int p = 0; p < 6; p++)
+        {
+            normalX[p] = planes[p]->normal.x;
+            normalY[p] = planes[p]->normal.y;
+            normalZ[p] = planes[p]->normal.z;
+            absX[p] = std::abs(normalX[p]);
+            absY[p] = std::abs(normalY[p]);
+            absZ[p] = std::abs(normalZ[p]);
+            distance[p] = planes[p]->distance;
+        }
+    }
+
+    // same test as AABB::isOnOrForwardPlan against every plane
+    bool isVisible(float cx, float cy, float cz, float ex, float ey, float ez) const
+    {
+        for (int p = 0; p < 6; p++)
+        {
+            const float signedDistance = normalX[p] * cx + normalY[p] * cy + normalZ[p] * cz - distance[p];
+            const float radius = absX[p] * ex + absY[p] * ey + absZ[p] * ez;
+            if (!(signedDistance + radius >= 0.0f))
+                return false;
+        }
+        return true;
+    }
+};
+
+// Tests boxes [first, end) of bounds against the frustum and fills visible with the
+// indices of the ones that are inside or crossing it, in increasing order; returns
+// how many. A box is culled once it is entirely behind one plane, like AABB::isOnFrustum.
+inline size_t cullBounds(const Frustum& frustum, const CullingBounds& bounds, size_t first, size_t end, std::vector<uint32_t>& visible)
+{
+    const CullingPlanes planes(frustum);
+    // every index is written, and kept only if its box passed, so there's no branch
+    // per box; the list is cut to size at the end
+    visible.resize(end > first ? end - first : 0);
+    uint32_t* out = visible.data();
+    size_t written = 0;
+    size_t i = first;
+
+#if defined(FRUSTUM_CULLER_AVX)
+    for (; i + 8 <= end; i += 8)
+    {
+        const __m256 cx = _mm256_loadu_ps(&bounds.centerX[i]);
+        const __m256 cy = _mm256_loadu_ps(&bounds.centerY[i]);
+        const __m256 cz = _mm256_loadu_ps(&bounds.centerZ[i]);
+        const __m256 ex = _mm256_loadu_ps(&bounds.extentX[i]);
+        const __m256 ey = _mm256_loadu_ps(&bounds.extentY[i]);
+        const __m256 ez = _mm256_loadu_ps(&bounds.extentZ[i]);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int p = 0; p < 6; p++)
+        {
+            __m256 d = _mm256_mul_ps(_mm256_set1_ps(planes.normalX[p]), cx);
+            d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(planes.normalY[p]), cy));
+            d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(planes.normalZ[p]), cz));
+            d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(planes.absX[p]), ex));
+            d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(planes.absY[p]), ey));
+            d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(planes.absZ[p]), ez));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, _mm256_set1_ps(planes.distance[p]), _CMP_GE_OQ));
+        }
+        const int mask = _mm256_movemask_ps(inside);
+        for (int lane = 0; lane < 8; lane++)
+        {
+            out[written] = static_cast<uint32_t>(i + lane);
+            written += (mask >> lane) & 1;
+        }
+    }
+#elif defined(FRUSTUM_CULLER_SSE)
+    for (; i + 4 <= end; i += 4)
+    {
+        const __m128 cx = _mm_loadu_ps(&bounds.centerX[i]);
+        const __m128 cy = _mm_loadu_ps(&bounds.centerY[i]);
+        const __m128 cz = _mm_loadu_ps(&bounds.centerZ[i]);
+        const __m128 ex = _mm_loadu_ps(&bounds.extentX[i]);
+        const __m128 ey = _mm_loadu_ps(&bounds.extentY[i]);
+        const __m128 ez = _mm_loadu_ps(&bounds.extentZ[i]);
+        __m128 inside = _mm_cmpeq_ps(cx, cx);   // all ones, except for NaN centers
+        for (int p = 0; p < 6; p++)
+        {
+            __m128 d = _mm_mul_ps(_mm_set1_ps(planes.normalX[p]), cx);
+            d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(planes.normalY[p]), cy));
+            d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(planes.normalZ[p]), cz));
+            d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(planes.absX[p]), ex));
+            d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(planes.absY[p]), ey));
+            d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(planes.absZ[p]), ez));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, _mm_set1_ps(planes.distance[p])));
+        }
+        const int mask = _mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            out[written] = static_cast<uint32_t>(i + lane);
+            written += (mask >> lane) & 1;
+        }
+    }
+#endif
+
+    // the boxes left over from the last full step, or all of them without SIMD
+    for (; i < end; i++)
+    {
+        out[written] = static_cast<uint32_t>(i);
+        written += planes.isVisible(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i],
+                                    bounds.extentX[i], bounds.extentY[i], bounds.extentZ[i]) ? 1 : 0;
+    }
+
+    visible.resize(written);
+    return written;
+}
+
+// every box of bounds
+inline size_t cullBounds(const Frustum& frustum, const CullingBounds& bounds, std::vector<uint32_t>& visible)
+{
+    return cullBounds(frustum, bounds, 0, bounds.size(), visible);
+}
+#endif
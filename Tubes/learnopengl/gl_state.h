@@ -0,0 +1,164 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/frame_stats.h>
+
+// Shadow copy of the GL state that changes between draws: current program, VAO,
+// active texture unit, the texture bound to each unit, depth func and blending. A
+// call only reaches the driver when it changes the value; frameStats counts the
+// calls issued and the ones filtered out. Starts from the GL defaults of a fresh
+// context, so everything binding these outside of glState has to call invalidate().
+class GLStateCache
+{
+public:
+    static const unsigned int MAX_TEXTURE_UNITS = 32;
+
+    void useProgram(GLuint program)
+    {
+        if (!changed(m_program, program))
+            return;
+        glUseProgram(program);
+    }
+
+    void bindVertexArray(GLuint vao)
+    {
+        if (!changed(m_vertexArray, vao))
+            return;
+        glBindVertexArray(vao);
+        frameStats.vaoBinds++;
+    }
+
+    void activeTexture(GLuint unit)
+    {
+        if (!changed(m_activeUnit, unit))
+            return;
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+
+    // binds texture to target on the given unit, making it the active unit if needed
+    void bindTexture(GLuint unit, GLenum target, GLuint texture)
+    {
+        int slot = targetSlot(target);
+        if (slot < 0 || unit >= MAX_TEXTURE_UNITS)
+        {
+            activeTexture(unit);
+            glBindTexture(target, texture);
+            frameStats.stateCalls++;
+            return;
+        }
+        if (m_textures[unit][slot] == texture)
+        {
+            frameStats.stateCallsFiltered++;
+            return;
+        }
+        activeTexture(unit);
+        m_textures[unit][slot] = texture;
+        glBindTexture(target, texture);
+        frameStats.stateCalls++;
+    }
+
+    void depthFunc(GLenum func)
+    {
+        if (!changed(m_depthFunc, func))
+            return;
+        glDepthFunc(func);
+    }
+
+    void setBlend(bool enabled)
+    {
+        if (!changed(m_blend, enabled ? 1u : 0u))
+            return;
+        if (enabled)
+            glEnable(GL_BLEND);
+        else
+            glDisable(GL_BLEND);
+    }
+
+    void blendFunc(GLenum source, GLenum destination)
+    {
+        if (m_blendSource == source && m_blendDestination == destination)
+        {
+            frameStats.stateCallsFiltered++;
+            return;
+        }
+        m_blendSource = source;
+        m_blendDestination = destination;
+        glBlendFunc(source, destination);
+        frameStats.stateCalls++;
+    }
+
+    // GL unbinds deleted objects by itself, these keep the shadow copy in step
+    void deleteTexture(GLuint texture)
+    {
+        for (unsigned int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+        {
+            for (GLuint& bound : m_textures[unit])
+            {
+                if (bound == texture)
+                    bound = 0;
+            }
+        }
+        glDeleteTextures(1, &texture);
+    }
+
+    void deleteVertexArray(GLuint vao)
+    {
+        if (m_vertexArray == vao)
+            m_vertexArray = 0;
+        glDeleteVertexArrays(1, &vao);
+    }
+
+    // forgets everything, for after code that changed this state behind glState's back
+    void invalidate()
+    {
+        m_program = m_vertexArray = m_activeUnit = UNKNOWN;
+        m_depthFunc = m_blend = UNKNOWN;
+        m_blendSource = m_blendDestination = UNKNOWN;
+        for (unsigned int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+        {
+            for (GLuint& bound : m_textures[unit])
+                bound = UNKNOWN;
+        }
+    }
+
+private:
+    static const GLuint UNKNOWN = 0xFFFFFFFFu;
+    static const int TRACKED_TARGETS = 3;
+
+    GLuint m_program = 0;
+    GLuint m_vertexArray = 0;
+    GLuint m_activeUnit = 0;
+    GLuint m_textures[MAX_TEXTURE_UNITS][TRACKED_TARGETS] = {};
+    GLenum m_depthFunc = GL_LESS;
+    GLuint m_blend = 0;
+    GLenum m_blendSource = GL_ONE;
+    GLenum m_blendDestination = GL_ZERO;
+
+    static int targetSlot(GLenum target)
+    {
+        switch (target)
+        {
+        case GL_TEXTURE_2D:       return 0;
+        case GL_TEXTURE_CUBE_MAP: return 1;
+        case GL_TEXTURE_2D_ARRAY: return 2;
+        default:                  return -1;
+        }
+    }
+
+    bool changed(GLuint& current, GLuint value)
+    {
+        if (current == value)
+        {
+            frameStats.stateCallsFiltered++;
+            return false;
+        }
+        current = value;
+        frameStats.stateCalls++;
+        return true;
+    }
+};
+
+inline GLStateCache glState;
+#endif
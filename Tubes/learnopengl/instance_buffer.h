@@ -0,0 +1,82 @@
+#ifndef INSTANCE_BUFFER_H
+#define INSTANCE_BUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstddef>
+#include <vector>
+
+// Per-instance placement read by the vertex shader with a divisor of 1:
+//   layout (location = N)     in vec4 aInstanceOffset;    // xyz translation, w uniform scale
+//   layout (location = N + 1) in vec4 aInstanceRotation;  // unit quaternion (x, y, z, w)
+// Applied before the model uniform. A VAO without the instance attributes enabled
+// reads their GL defaults (0, 0, 0, 1), which is the identity placement, so the same
+// shader serves both instanced and plain draws.
+struct InstanceData {
+    glm::vec4 offsetScale;
+    glm::vec4 rotation;
+};
+
+static_assert(sizeof(InstanceData) == 32, "InstanceData must stay two tightly packed vec4");
+
+// The placements of every copy of one mesh, kept on the CPU and streamed into their
+// own VBO. GL 3.3 has no base instance, so each instanced mesh gets its own buffer
+// and attaches it to its own VAO; the mesh's vertex and index buffers stay shared.
+class InstanceBuffer
+{
+public:
+    unsigned int VBO = 0;
+    std::vector<InstanceData> instances;
+
+    void create()
+    {
+        glGenBuffers(1, &VBO);
+    }
+
+    void destroy()
+    {
+        glDeleteBuffers(1, &VBO);
+        VBO = 0;
+    }
+
+    // points attributes location and location + 1 of the bound VAO at this buffer
+    void attach(GLuint location)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, offsetScale));
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+        glVertexAttribPointer(location + 1, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, rotation));
+        glEnableVertexAttribArray(location + 1);
+        glVertexAttribDivisor(location + 1, 1);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void clear()
+    {
+        instances.clear();
+    }
+
+    void add(const glm::vec3& translation, const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f), float scale = 1.0f)
+    {
+        instances.push_back({ glm::vec4(translation, scale), glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w) });
+    }
+
+    GLsizei count() const
+    {
+        return static_cast<GLsizei>(instances.size());
+    }
+
+    // sends the placements to the GPU; the buffer is orphaned first so a frame still
+    // drawing from the previous contents never stalls the upload
+    void upload()
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(InstanceData), instances.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+};
+#endif
@@ -6,7 +6,9 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <learnopengl/gl_state.h>
 #include <learnopengl/shader.h>
+#include <learnopengl/texture_upload.h>
 
 #include <string>
 #include <vector>
@@ -29,12 +31,41 @@ struct Vertex {
 	int m_BoneIDs[MAX_BONE_INFLUENCE];
 	//weights from each bone
 	float m_Weights[MAX_BONE_INFLUENCE];
+	//texture array layers of the diffuse, specular, normal and height map (Model's texture array mode)
+	int m_MaterialLayers[4] = {};
 };
 
 struct Texture {
     unsigned int id;
     string type;
     string path;
+    GLenum target = GL_TEXTURE_2D;  // GL_TEXTURE_2D_ARRAY when id is a shared texture array
+    unsigned int layer = 0;         // layer of the array holding this texture
+    // set when the texture streams in through a TextureUploadQueue: id is unused and
+    // the draw binds uploads->texture(upload), the placeholder until it's resident
+    const TextureUploadQueue* uploads = nullptr;
+    unsigned int upload = NO_TEXTURE_UPLOAD;
+};
+
+// one texture of a mesh and the unit its sampler reads in a given shader
+struct MaterialBinding {
+    GLuint unit;
+    GLenum target;
+    unsigned int texture;
+    const TextureUploadQueue* uploads;
+    unsigned int upload;
+
+    unsigned int resolve() const
+    {
+        return uploads ? uploads->texture(upload) : texture;
+    }
+};
+
+// a mesh's textures resolved against one shader program, built on the first draw
+// with that program so Draw only binds texture ids to units
+struct MaterialBindingTable {
+    unsigned int program;
+    vector<MaterialBinding> bindings;
 };
 
 class Mesh {
@@ -60,13 +91,38 @@ public:
     void Draw(Shader &shader) 
     {
         // bind appropriate textures
+        for (const MaterialBinding& binding : materialBindings(shader).bindings)
+            glState.bindTexture(binding.unit, binding.target, binding.resolve());
+        
+        // draw mesh
+        // the VAO and texture units stay bound, the next mesh only changes what differs
+        glState.bindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
+    }
+
+private:
+    // render data 
+    unsigned int VBO, EBO;
+    vector<MaterialBindingTable> bindingTables;
+
+    // returns the binding table for the shader, building it on first use. Must be
+    // called with the shader in use: its samplers are set to their units here, once.
+    const MaterialBindingTable& materialBindings(Shader &shader)
+    {
+        for (const MaterialBindingTable& table : bindingTables)
+        {
+            if (table.program == shader.ID)
+                return table;
+        }
+
+        MaterialBindingTable table;
+        table.program = shader.ID;
         unsigned int diffuseNr  = 1;
         unsigned int specularNr = 1;
         unsigned int normalNr   = 1;
         unsigned int heightNr   = 1;
         for(unsigned int i = 0; i < textures.size(); i++)
         {
-            glActiveTexture(GL_TEXTURE0 + i); // active proper texture unit before binding
             // retrieve texture number (the N in diffuse_textureN)
             string number;
             string name = textures[i].type;
@@ -79,25 +135,18 @@ public:
              else if(name == "texture_height")
                 number = std::to_string(heightNr++); // transfer unsigned int to string
 
-            // now set the sampler to the correct texture unit
-            glUniform1i(glGetUniformLocation(shader.ID, (name + number).c_str()), i);
-            // and finally bind the texture
-            glBindTexture(GL_TEXTURE_2D, textures[i].id);
+            // the unit is the program's own (see UniformTable), so every mesh drawn
+            // with this shader agrees on it and the sampler only has to be set once
+            GLint unit = shader.uniforms.samplerUnit(name + number);
+            if (unit < 0)
+                continue;   // the shader doesn't sample this texture
+            shader.setInt(name + number, unit);
+            table.bindings.push_back({ static_cast<GLuint>(unit), textures[i].target, textures[i].id, textures[i].uploads, textures[i].upload });
         }
-        
-        // draw mesh
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
-
-        // always good practice to set everything back to defaults once configured.
-        glActiveTexture(GL_TEXTURE0);
+        bindingTables.push_back(std::move(table));
+        return bindingTables.back();
     }
 
-private:
-    // render data 
-    unsigned int VBO, EBO;
-
     // initializes all the buffer objects/arrays
     void setupMesh()
     {
@@ -106,7 +155,7 @@ private:
         glGenBuffers(1, &VBO);
         glGenBuffers(1, &EBO);
 
-        glBindVertexArray(VAO);
+        glState.bindVertexArray(VAO);
         // load data into vertex buffers
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
         // A great thing about structs is that their memory layout is sequential for all its items.
@@ -140,7 +189,10 @@ private:
 		// weights
 		glEnableVertexAttribArray(6);
 		glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_Weights));
-        glBindVertexArray(0);
+		// material texture array layers
+		glEnableVertexAttribArray(7);
+		glVertexAttribIPointer(7, 4, GL_INT, sizeof(Vertex), (void*)offsetof(Vertex, m_MaterialLayers));
+        glState.bindVertexArray(0);
     }
 };
 #endif
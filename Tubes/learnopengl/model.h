@@ -12,17 +12,35 @@
 
 #include <learnopengl/mesh.h>
 #include <learnopengl/shader.h>
+#include <learnopengl/texture_registry.h>
+#include <learnopengl/texture_upload.h>
 
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <iostream>
 #include <map>
+#include <unordered_map>
+#include <algorithm>
 #include <vector>
 using namespace std;
 
 unsigned int TextureFromFile(const char *path, const string &directory, bool gamma = false);
 
+// With textureArrays set, material textures of the same size and channel count are
+// packed as the layers of one GL_TEXTURE_2D_ARRAY: Texture::id is the shared array and
+// Texture::layer its layer, and every vertex carries the layers of its mesh's first
+// diffuse, specular, normal and height map as an ivec4 at location 7. Shaders for this
+// mode declare the samplers as sampler2DArray and read
+//     texture(texture_diffuse1, vec3(TexCoords, aMaterialLayers.x))
+// Meshes whose textures share arrays then draw one after another with no texture
+// rebinds, and can go through the multi-draw and sorted submission paths.
+//
+// Given a TextureUploadQueue, the other material textures stream in through it
+// instead of TextureFromFile: meshes draw with the placeholder until each one is
+// resident, and loading the model doesn't decode a single image on the GL thread.
+// The queue has to outlive the model. Array layers still load while the model does,
+// since an array is only made once all its layers are known.
 class Model 
 {
 public:
@@ -31,13 +49,28 @@ public:
     vector<Mesh>    meshes;
     string directory;
     bool gammaCorrection;
+    bool textureArrays;
 
     // constructor, expects a filepath to a 3D model.
-    Model(string const &path, bool gamma = false) : gammaCorrection(gamma)
+    Model(string const &path, bool gamma = false, bool textureArrays = false, TextureUploadQueue* uploads = nullptr)
+        : gammaCorrection(gamma), textureArrays(textureArrays), uploads(uploads)
     {
         loadModel(path);
     }
 
+    // registry textures are released with textureHandles, the texture arrays and
+    // queued uploads are the model's own
+    ~Model()
+    {
+        for (unsigned int id : textureArrayIds)
+            glState.deleteTexture(id);
+        for (unsigned int upload : textureUploads)
+            uploads->release(upload);
+    }
+
+    Model(const Model&) = delete;
+    Model& operator=(const Model&) = delete;
+
     // draws the model, and thus all its meshes
     void Draw(Shader &shader)
     {
@@ -46,6 +79,25 @@ public:
     }
     
 private:
+    // texture array mode: one array per width, height and channel count, filled once all
+    // meshes are loaded
+    struct TextureArrayGroup {
+        int width, height, components;
+        unsigned int id;
+        vector<unsigned char*> layers;
+    };
+    vector<TextureArrayGroup> textureArrayGroups;
+    vector<unsigned int> textureArrayIds;
+
+    // streaming mode: every texture requested from uploads
+    TextureUploadQueue* uploads;
+    vector<unsigned int> textureUploads;
+
+    // one textureRegistry reference per file this model uses, found by its path in
+    // the material; textures_loaded[i] is the texture of textureHandles[i]
+    vector<TextureHandle> textureHandles;
+    unordered_map<string, size_t> textureIndex;
+
     // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
     void loadModel(string const &path)
     {
@@ -63,6 +115,8 @@ private:
 
         // process ASSIMP's root node recursively
         processNode(scene->mRootNode, scene);
+        if (textureArrays)
+            uploadTextureArrays();
     }
 
     // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
@@ -163,6 +217,14 @@ private:
         // 4. height maps
         std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
         textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
+
+        // array layers of the first map of each type, 0 where the mesh has none
+        const vector<Texture>* maps[4] = { &diffuseMaps, &specularMaps, &normalMaps, &heightMaps };
+        int layers[4];
+        for (int i = 0; i < 4; i++)
+            layers[i] = maps[i]->empty() ? 0 : static_cast<int>((*maps[i])[0].layer);
+        for (Vertex& vertex : vertices)
+            std::copy(layers, layers + 4, vertex.m_MaterialLayers);
         
         // return a mesh object created from the extracted mesh data
         return Mesh(vertices, indices, textures);
@@ -178,28 +240,106 @@ private:
             aiString str;
             mat->GetTexture(type, i, &str);
             // check if texture was loaded before and if so, continue to next iteration: skip loading a new texture
-            bool skip = false;
-            for(unsigned int j = 0; j < textures_loaded.size(); j++)
+            auto found = textureIndex.find(str.C_Str());
+            if(found != textureIndex.end())
             {
-                if(std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-                {
-                    textures.push_back(textures_loaded[j]);
-                    skip = true; // a texture with the same filepath has already been loaded, continue to next one. (optimization)
-                    break;
-                }
+                textures.push_back(textures_loaded[found->second]);
+                continue;
             }
-            if(!skip)
-            {   // if texture hasn't been loaded already, load it
-                Texture texture;
-                texture.id = TextureFromFile(str.C_Str(), this->directory);
-                texture.type = typeName;
-                texture.path = str.C_Str();
-                textures.push_back(texture);
-                textures_loaded.push_back(texture);  // store it as texture loaded for entire model, to ensure we won't unnecesery load duplicate textures.
+            // if texture hasn't been loaded by this model, load it, or share it with
+            // every other model that already has the same file
+            Texture texture;
+            TextureHandle handle;
+            const bool arrayLayer = textureArrays && loadTextureArrayLayer(str.C_Str(), texture);
+            if (!arrayLayer && uploads)
+            {
+                // not flipped, aiProcess_FlipUVs already flips the texture coordinates
+                texture.id = 0;
+                texture.uploads = uploads;
+                texture.upload = uploads->request(GL_TEXTURE_2D, { this->directory + '/' + str.C_Str() }, false);
+                textureUploads.push_back(texture.upload);
+            }
+            else if (!arrayLayer)
+            {
+                const char* path = str.C_Str();
+                handle = textureRegistry.acquire(this->directory + '/' + path, [&]() { return TextureFromFile(path, this->directory); });
+                texture.id = handle.id();
             }
+            texture.type = typeName;
+            texture.path = str.C_Str();
+            textures.push_back(texture);
+            textureIndex.emplace(texture.path, textures_loaded.size());
+            textures_loaded.push_back(texture);  // store it as texture loaded for entire model, to ensure we won't unnecesery load duplicate textures.
+            textureHandles.push_back(std::move(handle));
         }
         return textures;
     }
+
+    // decodes a material texture and gives it a layer in the array of its size and
+    // channel count; the array name is reserved here, its storage is made in
+    // uploadTextureArrays once every layer is known
+    bool loadTextureArrayLayer(const char *path, Texture &texture)
+    {
+        string filename = directory + '/' + string(path);
+        int width, height, nrComponents;
+        unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
+        if (!data)
+            return false;   // TextureFromFile reports it
+
+        GLint maxLayers = 0;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+        TextureArrayGroup* group = nullptr;
+        for (TextureArrayGroup& candidate : textureArrayGroups)
+        {
+            if (candidate.width == width && candidate.height == height && candidate.components == nrComponents &&
+                static_cast<GLint>(candidate.layers.size()) < maxLayers)
+            {
+                group = &candidate;
+                break;
+            }
+        }
+        if (!group)
+        {
+            textureArrayGroups.push_back({ width, height, nrComponents, 0, {} });
+            group = &textureArrayGroups.back();
+            glGenTextures(1, &group->id);
+            textureArrayIds.push_back(group->id);
+        }
+
+        texture.id = group->id;
+        texture.target = GL_TEXTURE_2D_ARRAY;
+        texture.layer = static_cast<unsigned int>(group->layers.size());
+        group->layers.push_back(data);
+        return true;
+    }
+
+    // creates every texture array with all its layers and mipmaps, then frees the decoded images
+    void uploadTextureArrays()
+    {
+        for (TextureArrayGroup& group : textureArrayGroups)
+        {
+            GLenum format = GL_RGBA;
+            if (group.components == 1)
+                format = GL_RED;
+            else if (group.components == 3)
+                format = GL_RGB;
+
+            glState.bindTexture(0, GL_TEXTURE_2D_ARRAY, group.id);
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, format, group.width, group.height, static_cast<GLsizei>(group.layers.size()), 0, format, GL_UNSIGNED_BYTE, NULL);
+            for (size_t layer = 0; layer < group.layers.size(); layer++)
+            {
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<GLint>(layer), group.width, group.height, 1, format, GL_UNSIGNED_BYTE, group.layers[layer]);
+                stbi_image_free(group.layers[layer]);
+            }
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        }
+        textureArrayGroups.clear();
+    }
 };
 
 
@@ -223,7 +363,7 @@ unsigned int TextureFromFile(const char *path, const string &directory, bool gam
         else if (nrComponents == 4)
             format = GL_RGBA;
 
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        glState.bindTexture(0, GL_TEXTURE_2D, textureID);
         glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
         glGenerateMipmap(GL_TEXTURE_2D);
 
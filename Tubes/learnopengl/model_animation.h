@@ -223,7 +223,7 @@ private:
 			else if (nrComponents == 4)
 				format = GL_RGBA;
 
-			glBindTexture(GL_TEXTURE_2D, textureID);
+			glState.bindTexture(0, GL_TEXTURE_2D, textureID);
 			glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
 			glGenerateMipmap(GL_TEXTURE_2D);
 
@@ -0,0 +1,355 @@
+#ifndef OBJ_LOADER_H
+#define OBJ_LOADER_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/mapped_file.h>
+#include <learnopengl/thread_pool.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Same layout as the first three members of mesh.h's Vertex
+struct ObjVertex {
+    glm::vec3 Position;
+    glm::vec3 Normal;
+    glm::vec2 TexCoords;
+};
+
+// indices [indexOffset, indexOffset + indexCount) of ObjMesh::indices use this material
+struct ObjMaterialGroup {
+    std::string  material;
+    unsigned int indexOffset;
+    unsigned int indexCount;
+};
+
+// Indexed triangle list of a whole OBJ file, its indices sorted into one contiguous
+// range per material (in order of first use), so each material is a single draw
+struct ObjMesh {
+    std::vector<ObjVertex>        vertices;
+    std::vector<unsigned int>     indices;
+    std::vector<ObjMaterialGroup> groups;
+};
+
+namespace obj {
+
+// a face corner: 0-based position, texture coord and normal index, -1 if absent
+struct Corner {
+    int32_t v, vt, vn;
+};
+
+struct MaterialRun {
+    std::string_view name;
+    size_t firstCorner;
+};
+
+// a run of whole lines, parsed by one task
+struct Chunk {
+    const char* begin;
+    const char* end;
+    size_t positions = 0, texCoords = 0, normals = 0;             // counting pass
+    size_t positionBase = 0, texCoordBase = 0, normalBase = 0;    // global index of the first one
+    std::vector<Corner> corners;            // 3 per triangle
+    std::vector<MaterialRun> runs;          // usemtl statements, by first corner
+    bool failed = false;
+};
+
+inline const char* skipSpaces(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    return p;
+}
+
+inline const char* lineEnd(const char* p, const char* end)
+{
+    const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return newline ? newline : end;
+}
+
+inline bool parseFloats(const char* p, const char* end, float* values, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        p = skipSpaces(p, end);
+        if (p < end && *p == '+')
+            p++;
+        std::from_chars_result result = std::from_chars(p, end, values[i]);
+        if (result.ec != std::errc())
+            return false;
+        p = result.ptr;
+    }
+    return true;
+}
+
+// resolves a 1-based (or negative, relative) OBJ index against the count seen so far
+inline int32_t parseIndex(const char*& p, const char* end, size_t seen)
+{
+    long long index = 0;
+    std::from_chars_result result = std::from_chars(p, end, index);
+    if (result.ec != std::errc() || index == 0)
+        return -2;
+    p = result.ptr;
+    long long resolved = index > 0 ? index - 1 : static_cast<long long>(seen) + index;
+    return (resolved < 0 || resolved > INT32_MAX) ? -2 : static_cast<int32_t>(resolved);
+}
+
+// must classify lines exactly like parseLines, which writes where this counted
+inline void countLines(Chunk& chunk)
+{
+    for (const char* p = chunk.begin; p < chunk.end; )
+    {
+        const char* end = lineEnd(p, chunk.end);
+        const char* line = skipSpaces(p, end);
+        p = end + 1;
+        if (end > line && end[-1] == '\r')
+            end--;
+        if (end - line < 2 || line[0] != 'v')
+            continue;
+        if (line[1] == ' ' || line[1] == '\t')
+            chunk.positions++;
+        else if (line[1] == 't')
+            chunk.texCoords++;
+        else if (line[1] == 'n')
+            chunk.normals++;
+    }
+}
+
+// parses the chunk's lines, writing v/vt/vn straight into the shared arrays at the
+// chunk's bases and triangulating faces of any number of corners as fans
+inline void parseLines(Chunk& chunk, glm::vec3* positions, glm::vec2* texCoords, glm::vec3* normals)
+{
+    size_t v = chunk.positionBase, vt = chunk.texCoordBase, vn = chunk.normalBase;
+    for (const char* p = chunk.begin; p < chunk.end && !chunk.failed; )
+    {
+        const char* end = lineEnd(p, chunk.end);
+        const char* line = skipSpaces(p, end);
+        p = end + 1;
+        if (end > line && end[-1] == '\r')
+            end--;
+        if (end - line < 2)
+            continue;
+
+        if (line[0] == 'v' && (line[1] == ' ' || line[1] == '\t'))
+            chunk.failed = !parseFloats(line + 1, end, &positions[v++].x, 3);
+        else if (line[0] == 'v' && line[1] == 't')
+            chunk.failed = !parseFloats(line + 2, end, &texCoords[vt++].x, 2);
+        else if (line[0] == 'v' && line[1] == 'n')
+            chunk.failed = !parseFloats(line + 2, end, &normals[vn++].x, 3);
+        else if (line[0] == 'f' && (line[1] == ' ' || line[1] == '\t'))
+        {
+            // a fan only needs the first corner and the one before, so a face is
+            // emitted as it's read; faces with fewer than 3 corners draw nothing
+            int count = 0;
+            Corner first = {}, previous = {};
+            const char* q = skipSpaces(line + 1, end);
+            while (q < end)
+            {
+                Corner corner = { parseIndex(q, end, v), -1, -1 };
+                if (q < end && *q == '/')
+                {
+                    q++;
+                    if (q < end && *q != '/')
+                        corner.vt = parseIndex(q, end, vt);
+                    if (q < end && *q == '/')
+                    {
+                        q++;
+                        corner.vn = parseIndex(q, end, vn);
+                    }
+                }
+                if (corner.v < 0 || corner.vt < -1 || corner.vn < -1)
+                {
+                    chunk.failed = true;
+                    break;
+                }
+                if (count == 0)
+                    first = corner;
+                else if (count >= 2)
+                {
+                    chunk.corners.push_back(first);
+                    chunk.corners.push_back(previous);
+                    chunk.corners.push_back(corner);
+                }
+                previous = corner;
+                count++;
+                q = skipSpaces(q, end);
+            }
+        }
+        else if (end - line > 7 && std::strncmp(line, "usemtl", 6) == 0 && (line[6] == ' ' || line[6] == '\t'))
+        {
+            const char* name = skipSpaces(line + 6, end);
+            const char* nameEnd = end;
+            while (nameEnd > name && (nameEnd[-1] == ' ' || nameEnd[-1] == '\t'))
+                nameEnd--;
+            chunk.runs.push_back({ std::string_view(name, nameEnd - name), chunk.corners.size() });
+        }
+    }
+}
+
+} // namespace obj
+
+// Loads the triangles of an OBJ file straight from a memory mapping. The file is split
+// into chunks on line boundaries that are parsed in parallel on workers: one pass
+// counts each chunk's v/vt/vn lines so every chunk knows where its attributes land,
+// a second parses them in place with std::from_chars. Corners are then welded into
+// unique vertices and the triangles grouped by material. Only positions, texture
+// coords and normals are read; groups, smoothing groups and the mtllib are ignored.
+inline bool loadObj(const std::string& path, ObjMesh& mesh, ThreadPool& workers)
+{
+    MappedFile file;
+    if (!file.open(path.c_str()))
+    {
+        std::cout << "ERROR::OBJ_LOADER::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+        return false;
+    }
+    const char* data = reinterpret_cast<const char*>(file.data());
+    const char* dataEnd = data + file.size();
+
+    // a few chunks per worker so uneven chunks still balance, none smaller than 64kB
+    const size_t MIN_CHUNK_BYTES = 64 * 1024;
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(workers.size() * 4, file.size() / MIN_CHUNK_BYTES));
+    std::vector<obj::Chunk> chunks;
+    for (const char* p = data; p < dataEnd; )
+    {
+        const char* end = p + std::min<size_t>(dataEnd - p, file.size() / chunkCount + 1);
+        end = (end < dataEnd) ? obj::lineEnd(end, dataEnd) + 1 : dataEnd;
+        chunks.push_back(obj::Chunk());
+        chunks.back().begin = p;
+        chunks.back().end = std::min(end, dataEnd);
+        p = chunks.back().end;
+    }
+
+    std::vector<std::future<void>> tasks;
+    for (obj::Chunk& chunk : chunks)
+        tasks.push_back(workers.submit([&chunk] { obj::countLines(chunk); }));
+    for (std::future<void>& task : tasks)
+        task.get();
+
+    size_t positionCount = 0, texCoordCount = 0, normalCount = 0;
+    for (obj::Chunk& chunk : chunks)
+    {
+        chunk.positionBase = positionCount;
+        chunk.texCoordBase = texCoordCount;
+        chunk.normalBase = normalCount;
+        positionCount += chunk.positions;
+        texCoordCount += chunk.texCoords;
+        normalCount += chunk.normals;
+    }
+    std::vector<glm::vec3> positions(positionCount);
+    std::vector<glm::vec2> texCoords(texCoordCount);
+    std::vector<glm::vec3> normals(normalCount);
+
+    tasks.clear();
+    for (obj::Chunk& chunk : chunks)
+        tasks.push_back(workers.submit([&chunk, &positions, &texCoords, &normals] {
+            obj::parseLines(chunk, positions.data(), texCoords.data(), normals.data());
+        }));
+    for (std::future<void>& task : tasks)
+        task.get();
+
+    // triangle spans per material, in order of first use; faces before any usemtl
+    // (or that continue a material from the previous chunk) keep the current one
+    struct Span { const obj::Chunk* chunk; size_t begin, end; };
+    std::vector<std::string_view> materials;
+    std::vector<std::vector<Span>> spans;
+    std::unordered_map<std::string_view, size_t> materialIds;
+    size_t current = 0;
+    materials.push_back(std::string_view());
+    spans.emplace_back();
+    size_t cornerCount = 0;
+    for (const obj::Chunk& chunk : chunks)
+    {
+        if (chunk.failed)
+        {
+            std::cout << "ERROR::OBJ_LOADER::PARSE_FAILED: " << path << " near byte " << (chunk.begin - data) << std::endl;
+            return false;
+        }
+        cornerCount += chunk.corners.size();
+        size_t begin = 0;
+        for (size_t r = 0; r <= chunk.runs.size(); r++)
+        {
+            size_t end = (r < chunk.runs.size()) ? chunk.runs[r].firstCorner : chunk.corners.size();
+            if (end > begin)
+                spans[current].push_back({ &chunk, begin, end });
+            begin = end;
+            if (r == chunk.runs.size())
+                break;
+            auto found = materialIds.find(chunk.runs[r].name);
+            if (found == materialIds.end())
+            {
+                found = materialIds.emplace(chunk.runs[r].name, materials.size()).first;
+                materials.push_back(chunk.runs[r].name);
+                spans.emplace_back();
+            }
+            current = found->second;
+        }
+    }
+
+    // welds identical (v, vt, vn) corners with an open addressing hash table
+    mesh.vertices.clear();
+    mesh.indices.clear();
+    mesh.groups.clear();
+    mesh.indices.reserve(cornerCount);
+    size_t tableSize = 16;
+    while (tableSize < cornerCount * 2)
+        tableSize <<= 1;
+    const uint32_t EMPTY = 0xFFFFFFFFu;
+    std::vector<uint32_t> table(tableSize, EMPTY);
+    std::vector<obj::Corner> keys;
+
+    for (size_t m = 0; m < materials.size(); m++)
+    {
+        if (spans[m].empty())
+            continue;
+        ObjMaterialGroup group;
+        group.material = std::string(materials[m]);
+        group.indexOffset = static_cast<unsigned int>(mesh.indices.size());
+        for (const Span& span : spans[m])
+        {
+            for (size_t c = span.begin; c < span.end; c++)
+            {
+                const obj::Corner& corner = span.chunk->corners[c];
+                if (size_t(corner.v) >= positionCount || (corner.vt >= 0 && size_t(corner.vt) >= texCoordCount) ||
+                    (corner.vn >= 0 && size_t(corner.vn) >= normalCount))
+                {
+                    std::cout << "ERROR::OBJ_LOADER::INDEX_OUT_OF_RANGE: " << path << std::endl;
+                    return false;
+                }
+                uint64_t hash = 14695981039346656037ull;
+                hash = (hash ^ uint32_t(corner.v)) * 1099511628211ull;
+                hash = (hash ^ uint32_t(corner.vt)) * 1099511628211ull;
+                hash = (hash ^ uint32_t(corner.vn)) * 1099511628211ull;
+                size_t slot = static_cast<size_t>(hash) & (tableSize - 1);
+                while (table[slot] != EMPTY)
+                {
+                    const obj::Corner& key = keys[table[slot]];
+                    if (key.v == corner.v && key.vt == corner.vt && key.vn == corner.vn)
+                        break;
+                    slot = (slot + 1) & (tableSize - 1);
+                }
+                if (table[slot] == EMPTY)
+                {
+                    table[slot] = static_cast<uint32_t>(keys.size());
+                    keys.push_back(corner);
+                    ObjVertex vertex;
+                    vertex.Position = positions[corner.v];
+                    vertex.TexCoords = corner.vt >= 0 ? texCoords[corner.vt] : glm::vec2(0.0f);
+                    vertex.Normal = corner.vn >= 0 ? normals[corner.vn] : glm::vec3(0.0f);
+                    mesh.vertices.push_back(vertex);
+                }
+                mesh.indices.push_back(table[slot]);
+            }
+        }
+        group.indexCount = static_cast<unsigned int>(mesh.indices.size()) - group.indexOffset;
+        mesh.groups.push_back(group);
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,322 @@
+#ifndef OCCLUSION_CULLER_H
+#define OCCLUSION_CULLER_H
+
+#include <glm/glm.hpp>
+
+#include <learnopengl/thread_pool.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Same detection as frustum_culler.h; the rasterizer covers 4 pixels of a row per
+// step with SSE and falls back to one at a time without it.
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define OCCLUSION_CULLER_SSE
+#include <xmmintrin.h>
+#endif
+
+// Geometry an object occludes with: xyz positions (three floats per vertex) and a
+// triangle list. Usually the object's own mesh when it's low poly, or a simplified
+// stand-in that stays inside it.
+struct OccluderMesh {
+    std::vector<float> positions;
+    std::vector<uint32_t> indices;
+};
+
+// Software occlusion culling on the CPU. Every frame:
+//   begin(viewProjection), addOccluder() for each occluder, render(), then ask
+//   isVisible() for each object's world space AABB before drawing it.
+// render() rasterizes the occluders' depth (nothing else) into a small buffer in
+// 64x32 tiles spread over the ThreadPool, and keeps the farthest depth of every 8x8
+// pixel block.
+// An object is occluded when its nearest point lies behind that depth in every block
+// its screen rectangle touches. Depth is NDC z mapped to [0, 1], rows go bottom up.
+class OcclusionCuller
+{
+public:
+    static constexpr int WIDTH = 256;
+    static constexpr int HEIGHT = 128;
+    static constexpr int TILE_WIDTH = 64;
+    static constexpr int TILE_HEIGHT = 32;
+    static constexpr int TILES_X = WIDTH / TILE_WIDTH;
+    static constexpr int TILES_Y = HEIGHT / TILE_HEIGHT;
+    static constexpr int BLOCK_SIZE = 8;
+    static constexpr int BLOCKS_X = WIDTH / BLOCK_SIZE;
+    static constexpr int BLOCKS_Y = HEIGHT / BLOCK_SIZE;
+
+    explicit OcclusionCuller(ThreadPool& workers)
+        : m_workers(workers), m_depth(WIDTH * HEIGHT, FLT_MAX), m_blockDepth(BLOCKS_X * BLOCKS_Y, FLT_MAX), m_bins(TILES_X * TILES_Y)
+    {
+    }
+
+    // starts a new depth buffer seen through viewProjection; until render() runs,
+    // everything is visible
+    void begin(const glm::mat4& viewProjection)
+    {
+        m_viewProjection = viewProjection;
+        m_triangles.clear();
+        for (std::vector<uint32_t>& bin : m_bins)
+            bin.clear();
+        m_rendered = false;
+    }
+
+    // projects the mesh placed by model and bins its triangles by tile. Triangles
+    // crossing the near plane are dropped rather than clipped, which can only leave
+    // an object visible that would have been hidden.
+    void addOccluder(const OccluderMesh& mesh, const glm::mat4& model)
+    {
+        const glm::mat4 transform = m_viewProjection * model;
+        m_projected.resize(mesh.positions.size() / 3);
+        for (size_t v = 0; v < m_projected.size(); v++)
+        {
+            const glm::vec4 clip = transform * glm::vec4(mesh.positions[v * 3], mesh.positions[v * 3 + 1], mesh.positions[v * 3 + 2], 1.0f);
+            m_projected[v] = clip;
+        }
+
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+        {
+            Triangle t;
+            bool inFront = true;
+            for (int k = 0; k < 3; k++)
+            {
+                const glm::vec4& clip = m_projected[mesh.indices[i + k]];
+                inFront = inFront && clip.z >= -clip.w && clip.w > 0.0f;
+                const float invW = 1.0f / clip.w;
+                t.x[k] = (clip.x * invW * 0.5f + 0.5f) * WIDTH;
+                t.y[k] = (clip.y * invW * 0.5f + 0.5f) * HEIGHT;
+                t.z[k] = clip.z * invW * 0.5f + 0.5f;
+            }
+            if (inFront)
+                bin(t);
+        }
+    }
+
+    // rasterizes the binned triangles and builds the block depths. The calling thread
+    // takes tiles alongside the workers, so the frame never waits behind whatever else
+    // is queued on the pool (texture decodes); a task that starts after every tile is
+    // taken returns without touching the culler.
+    void render()
+    {
+        auto job = std::make_shared<RenderJob>();
+        const int helpers = std::min<int>(TILES_X * TILES_Y, static_cast<int>(m_workers.size())) - 1;
+        for (int i = 0; i < helpers; i++)
+            m_workers.submit([this, job] { renderTiles(*job); });
+        renderTiles(*job);
+        while (job->finished.load() < TILES_X * TILES_Y)
+            std::this_thread::yield();
+        m_rendered = true;
+    }
+
+    // true unless the world space box [min, max] is entirely behind the occluders.
+    // Boxes reaching in front of the near plane or off the screen count as visible;
+    // the frustum test is what rejects those.
+    bool isVisible(const glm::vec3& min, const glm::vec3& max) const
+    {
+        if (!m_rendered)
+            return true;
+        float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, nearest = FLT_MAX;
+        for (int corner = 0; corner < 8; corner++)
+        {
+            const glm::vec4 clip = m_viewProjection * glm::vec4(corner & 1 ? max.x : min.x, corner & 2 ? max.y : min.y,
+                                                                corner & 4 ? max.z : min.z, 1.0f);
+            if (clip.z < -clip.w || clip.w <= 0.0f)
+                return true;
+            const float invW = 1.0f / clip.w;
+            const float x = (clip.x * invW * 0.5f + 0.5f) * WIDTH;
+            const float y = (clip.y * invW * 0.5f + 0.5f) * HEIGHT;
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            nearest = std::min(nearest, clip.z * invW * 0.5f + 0.5f);
+        }
+        // a pixel counts as covered when its center is, so the rectangle grows by a
+        // pixel to take in the ones the box only partly overlaps
+        const int x0 = std::max(0, static_cast<int>(std::floor(minX)) - 1);
+        const int y0 = std::max(0, static_cast<int>(std::floor(minY)) - 1);
+        const int x1 = std::min(WIDTH - 1, static_cast<int>(std::floor(maxX)) + 1);
+        const int y1 = std::min(HEIGHT - 1, static_cast<int>(std::floor(maxY)) + 1);
+        if (x0 > x1 || y0 > y1)
+            return true;
+        for (int by = y0 / BLOCK_SIZE; by <= y1 / BLOCK_SIZE; by++)
+        {
+            for (int bx = x0 / BLOCK_SIZE; bx <= x1 / BLOCK_SIZE; bx++)
+            {
+                if (m_blockDepth[by * BLOCKS_X + bx] >= nearest)
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    // the matrix of the last begin(); the occluders only need drawing again when it changes
+    const glm::mat4& viewProjection() const
+    {
+        return m_viewProjection;
+    }
+
+    size_t triangleCount() const
+    {
+        return m_triangles.size();
+    }
+
+    // WIDTH x HEIGHT depths of the last render(), FLT_MAX where no occluder is
+    const float* depth() const
+    {
+        return m_depth.data();
+    }
+
+private:
+    // screen space, x and y in pixels, z the [0, 1] depth
+    struct Triangle {
+        float x[3], y[3], z[3];
+    };
+
+    ThreadPool& m_workers;
+    glm::mat4 m_viewProjection{ 1.0f };
+    std::vector<float> m_depth;
+    std::vector<float> m_blockDepth;
+    std::vector<Triangle> m_triangles;
+    std::vector<std::vector<uint32_t>> m_bins;    // triangle indices per tile
+    std::vector<glm::vec4> m_projected;
+    bool m_rendered = false;
+
+    // tiles of one render(), handed out in order to whichever thread asks next
+    struct RenderJob {
+        std::atomic<int> next{ 0 };
+        std::atomic<int> finished{ 0 };
+    };
+
+    void renderTiles(RenderJob& job)
+    {
+        for (int tile = job.next++; tile < TILES_X * TILES_Y; tile = job.next++)
+        {
+            renderTile(tile);
+            job.finished++;
+        }
+    }
+
+    void bin(const Triangle& t)
+    {
+        const float minX = std::min({ t.x[0], t.x[1], t.x[2] }), maxX = std::max({ t.x[0], t.x[1], t.x[2] });
+        const float minY = std::min({ t.y[0], t.y[1], t.y[2] }), maxY = std::max({ t.y[0], t.y[1], t.y[2] });
+        if (maxX < 0.0f || maxY < 0.0f || minX >= WIDTH || minY >= HEIGHT)
+            return;
+        const int tx0 = static_cast<int>(std::max(minX, 0.0f)) / TILE_WIDTH, tx1 = static_cast<int>(std::min(maxX, WIDTH - 1.0f)) / TILE_WIDTH;
+        const int ty0 = static_cast<int>(std::max(minY, 0.0f)) / TILE_HEIGHT, ty1 = static_cast<int>(std::min(maxY, HEIGHT - 1.0f)) / TILE_HEIGHT;
+        const uint32_t index = static_cast<uint32_t>(m_triangles.size());
+        m_triangles.push_back(t);
+        for (int ty = ty0; ty <= ty1; ty++)
+        {
+            for (int tx = tx0; tx <= tx1; tx++)
+                m_bins[ty * TILES_X + tx].push_back(index);
+        }
+    }
+
+    // clears the tile, draws its bin and computes its blocks; tiles share nothing,
+    // so any number of them can run at once
+    void renderTile(int tile)
+    {
+        const int tileX = (tile % TILES_X) * TILE_WIDTH;
+        const int tileY = (tile / TILES_X) * TILE_HEIGHT;
+        for (int y = tileY; y < tileY + TILE_HEIGHT; y++)
+            std::fill_n(&m_depth[y * WIDTH + tileX], TILE_WIDTH, FLT_MAX);
+
+        for (uint32_t index : m_bins[tile])
+            rasterize(m_triangles[index], tileX, tileY);
+
+        for (int by = tileY / BLOCK_SIZE; by < (tileY + TILE_HEIGHT) / BLOCK_SIZE; by++)
+        {
+            for (int bx = tileX / BLOCK_SIZE; bx < (tileX + TILE_WIDTH) / BLOCK_SIZE; bx++)
+            {
+                float farthest = 0.0f;
+                for (int y = by * BLOCK_SIZE; y < (by + 1) * BLOCK_SIZE; y++)
+                {
+                    for (int x = bx * BLOCK_SIZE; x < (bx + 1) * BLOCK_SIZE; x++)
+                        farthest = std::max(farthest, m_depth[y * WIDTH + x]);
+                }
+                m_blockDepth[by * BLOCKS_X + bx] = farthest;
+            }
+        }
+    }
+
+    // depth-only, both faces: keeps the nearest z at every pixel center inside the
+    // triangle and the tile
+    void rasterize(const Triangle& t, int tileX, int tileY)
+    {
+        float x[3] = { t.x[0], t.x[1], t.x[2] }, y[3] = { t.y[0], t.y[1], t.y[2] }, z[3] = { t.z[0], t.z[1], t.z[2] };
+        float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+        if (std::abs(area) < 1e-6f)
+            return;
+        if (area < 0.0f)
+        {
+            std::swap(x[1], x[2]);
+            std::swap(y[1], y[2]);
+            std::swap(z[1], z[2]);
+            area = -area;
+        }
+
+        // edge k is the one opposite vertex k, E(px, py) = a * px + b * py + c, positive inside
+        float a[3], b[3], c[3];
+        for (int k = 0; k < 3; k++)
+        {
+            const int from = (k + 1) % 3, to = (k + 2) % 3;
+            a[k] = y[from] - y[to];
+            b[k] = x[to] - x[from];
+            c[k] = x[from] * y[to] - y[from] * x[to];
+        }
+        // z is affine in screen space: z0 + (E1 * (z1 - z0) + E2 * (z2 - z0)) / area
+        const float dz1 = (z[1] - z[0]) / area, dz2 = (z[2] - z[0]) / area;
+        const float za = a[1] * dz1 + a[2] * dz2;
+        const float zb = b[1] * dz1 + b[2] * dz2;
+        const float zc = z[0] + c[1] * dz1 + c[2] * dz2;
+
+        // the bounds clamped to the tile; x0 is rounded down to a multiple of 4, which
+        // tile edges already are
+        const int x0 = static_cast<int>(std::max(std::min({ x[0], x[1], x[2] }), static_cast<float>(tileX))) & ~3;
+        const int x1 = static_cast<int>(std::min(std::max({ x[0], x[1], x[2] }), tileX + TILE_WIDTH - 1.0f));
+        const int y0 = static_cast<int>(std::max(std::min({ y[0], y[1], y[2] }), static_cast<float>(tileY)));
+        const int y1 = static_cast<int>(std::min(std::max({ y[0], y[1], y[2] }), tileY + TILE_HEIGHT - 1.0f));
+
+        for (int py = y0; py <= y1; py++)
+        {
+            const float fy = py + 0.5f;
+            float* row = &m_depth[py * WIDTH];
+#if defined(OCCLUSION_CULLER_SSE)
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 lane = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+            const __m128 rowE0 = _mm_set1_ps(b[0] * fy + c[0]), rowE1 = _mm_set1_ps(b[1] * fy + c[1]), rowE2 = _mm_set1_ps(b[2] * fy + c[2]);
+            const __m128 rowZ = _mm_set1_ps(zb * fy + zc);
+            for (int px = x0; px <= x1; px += 4)
+            {
+                const __m128 fx = _mm_add_ps(_mm_set1_ps(static_cast<float>(px)), lane);
+                const __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[0]), fx), rowE0);
+                const __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[1]), fx), rowE1);
+                const __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[2]), fx), rowE2);
+                const __m128 inside = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_and_ps(_mm_cmpge_ps(e1, zero), _mm_cmpge_ps(e2, zero)));
+                if (_mm_movemask_ps(inside) == 0)
+                    continue;
+                const __m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(za), fx), rowZ);
+                const __m128 old = _mm_loadu_ps(row + px);
+                const __m128 nearer = _mm_min_ps(old, depth);
+                _mm_storeu_ps(row + px, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+            }
+#else
+            for (int px = x0; px <= x1; px++)
+            {
+                const float fx = px + 0.5f;
+                if (a[0] * fx + b[0] * fy + c[0] >= 0.0f && a[1] * fx + b[1] * fy + c[1] >= 0.0f && a[2] * fx + b[2] * fy + c[2] >= 0.0f)
+                    row[px] = std::min(row[px], za * fx + zb * fy + zc);
+            }
+#endif
+        }
+    }
+};
+#endif
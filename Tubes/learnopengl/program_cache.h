@@ -0,0 +1,225 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// ARB_get_program_binary (core since 4.1) is above the 3.3 glad loader, so its enums
+// and entry points are defined and loaded here
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+// programs restored from the cache (hits) and compiled from source (misses) since startup
+struct ProgramCacheStats {
+    unsigned int hits = 0;
+    unsigned int misses = 0;
+    unsigned int stores = 0;
+};
+
+namespace programcache {
+
+typedef void (APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+struct State {
+    GetProgramBinaryProc  getProgramBinary = nullptr;
+    ProgramBinaryProc     programBinary = nullptr;
+    ProgramParameteriProc programParameteri = nullptr;
+    bool enabled = false;
+    std::string directory;
+    std::string driver;     // vendor, renderer and version, part of every key
+    ProgramCacheStats stats;
+};
+
+inline State state;
+
+const uint32_t MAGIC = 0x42504C47;  // "GLPB"
+const uint32_t VERSION = 1;
+
+struct EntryHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t length;
+};
+
+inline std::string entryPath(uint64_t key)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return state.directory + "/" + name;
+}
+
+} // namespace programcache
+
+// Enables the on-disk program binary cache, call once after gladLoadGLLoader with the
+// same loader. Without ARB_get_program_binary (or any binary format) it stays off and
+// every Shader is compiled from source as before.
+inline bool initProgramCache(GLADloadproc load, const std::string& directory = "shader_cache")
+{
+    using namespace programcache;
+    bool supported = GLVersion.major > 4 || (GLVersion.major == 4 && GLVersion.minor >= 1);
+    GLint extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for (GLint i = 0; i < extensions && !supported; i++)
+        supported = std::strcmp(reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i)), "GL_ARB_get_program_binary") == 0;
+    GLint formats = 0;
+    if (supported)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+    state.getProgramBinary = reinterpret_cast<GetProgramBinaryProc>(load("glGetProgramBinary"));
+    state.programBinary = reinterpret_cast<ProgramBinaryProc>(load("glProgramBinary"));
+    state.programParameteri = reinterpret_cast<ProgramParameteriProc>(load("glProgramParameteri"));
+    state.enabled = supported && formats > 0 && state.getProgramBinary && state.programBinary && state.programParameteri;
+    if (!state.enabled)
+    {
+        std::cout << "program cache disabled: no program binary support" << std::endl;
+        return false;
+    }
+
+    state.directory = directory;
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    state.driver = std::string(reinterpret_cast<const char*>(glGetString(GL_VENDOR))) + "\n" +
+                   reinterpret_cast<const char*>(glGetString(GL_RENDERER)) + "\n" +
+                   reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    return true;
+}
+
+inline const ProgramCacheStats& programCacheStats()
+{
+    return programcache::state.stats;
+}
+
+// FNV-1a over every stage's source and the driver string, so an edited shader or an
+// updated driver never picks up a stale binary
+inline uint64_t programCacheKey(std::initializer_list<const std::string*> sources)
+{
+    uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](const std::string& text) {
+        for (unsigned char c : text)
+            hash = (hash ^ c) * 1099511628211ull;
+        hash = (hash ^ 0xFF) * 1099511628211ull;   // stage separator
+    };
+    for (const std::string* source : sources)
+        add(*source);
+    add(programcache::state.driver);
+    return hash;
+}
+
+// returns a linked program restored from the cache, or 0 if it has to be compiled
+inline unsigned int loadCachedProgram(uint64_t key)
+{
+    using namespace programcache;
+    if (!state.enabled)
+    {
+        state.stats.misses++;
+        return 0;
+    }
+
+    std::ifstream file(entryPath(key), std::ios::binary);
+    EntryHeader header;
+    std::vector<char> binary;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.magic == MAGIC && header.version == VERSION && header.key == key)
+    {
+        binary.resize(header.length);
+        file.read(binary.data(), binary.size());
+    }
+    if (binary.empty() || !file)
+    {
+        state.stats.misses++;
+        return 0;
+    }
+
+    unsigned int program = glCreateProgram();
+    state.programBinary(program, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        // the driver may reject its own binaries at any time, the source path recovers
+        glDeleteProgram(program);
+        state.stats.misses++;
+        return 0;
+    }
+    state.stats.hits++;
+    return program;
+}
+
+// call between glCreateProgram and glLinkProgram of a program that will be stored
+inline void prepareProgramForCache(unsigned int program)
+{
+    if (programcache::state.enabled)
+        programcache::state.programParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+// writes a successfully linked program to the cache
+inline void storeCachedProgram(uint64_t key, unsigned int program)
+{
+    using namespace programcache;
+    if (!state.enabled)
+        return;
+    GLint success = 0, length = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (!success || length <= 0)
+        return;
+
+    EntryHeader header;
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.key = key;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    state.getProgramBinary(program, length, &length, &format, binary.data());
+    header.format = format;
+    header.length = static_cast<uint32_t>(length);
+
+    // written to a temporary file first and renamed over the entry, like TextureCache,
+    // so a crash or a second instance never leaves half an entry behind. The clock
+    // keeps two instances' temporary files apart.
+    const std::string path = entryPath(key);
+    const std::string temp = path + ".tmp" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    {
+        std::ofstream file(temp, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), length);
+        if (!file)
+        {
+            std::cout << "ERROR::PROGRAM_CACHE::WRITE_FAILED: " << path << std::endl;
+            std::error_code error;
+            file.close();
+            std::filesystem::remove(temp, error);
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temp, path, error);
+    if (error)
+    {
+        std::cout << "ERROR::PROGRAM_CACHE::WRITE_FAILED: " << path << std::endl;
+        std::filesystem::remove(temp, error);
+        return;
+    }
+    state.stats.stores++;
+}
+#endif
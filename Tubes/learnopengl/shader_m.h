@@ -4,6 +4,11 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <learnopengl/camera_block.h>
+#include <learnopengl/gl_state.h>
+#include <learnopengl/program_cache.h>
+#include <learnopengl/uniform_table.h>
+
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -13,6 +18,7 @@ class Shader
 {
 public:
     unsigned int ID;
+    UniformTable uniforms;  // active uniform locations, read once the program is linked
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath)
@@ -47,7 +53,16 @@ public:
         }
         const char* vShaderCode = vertexCode.c_str();
         const char * fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
+        // 2. restore the linked program from the cache if it was built before
+        uint64_t cacheKey = programCacheKey({ &vertexCode, &fragmentCode });
+        ID = loadCachedProgram(cacheKey);
+        if (ID != 0)
+        {
+            uniforms.build(ID);
+            bindCameraBlock(ID);
+            return;
+        }
+        // 3. compile shaders
         unsigned int vertex, fragment;
         // vertex shader
         vertex = glCreateShader(GL_VERTEX_SHADER);
@@ -61,10 +76,14 @@ public:
         checkCompileErrors(fragment, "FRAGMENT");
         // shader Program
         ID = glCreateProgram();
+        prepareProgramForCache(ID);
         glAttachShader(ID, vertex);
         glAttachShader(ID, fragment);
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM");
+        storeCachedProgram(cacheKey, ID);
+        uniforms.build(ID);
+        bindCameraBlock(ID);
         // delete the shaders as they're linked into our program now and no longer necessery
         glDeleteShader(vertex);
         glDeleteShader(fragment);
@@ -74,65 +93,161 @@ public:
     // ------------------------------------------------------------------------
     void use() const
     { 
-        glUseProgram(ID); 
+        glState.useProgram(ID);
     }
     // utility uniform functions
     // ------------------------------------------------------------------------
     void setBool(const std::string &name, bool value) const
-    {         
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+    {
+        setBool(uniforms.location(name), value);
+    }
+    void setBool(UniformId id, bool value) const
+    {
+        setBool(uniforms.location(id), value);
+    }
+    void setBool(GLint location, bool value) const
+    {
+        glUniform1i(location, (int)value);
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string &name, int value) const
-    { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+    {
+        setInt(uniforms.location(name), value);
+    }
+    void setInt(UniformId id, int value) const
+    {
+        setInt(uniforms.location(id), value);
+    }
+    void setInt(GLint location, int value) const
+    {
+        glUniform1i(location, value);
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string &name, float value) const
-    { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+    {
+        setFloat(uniforms.location(name), value);
+    }
+    void setFloat(UniformId id, float value) const
+    {
+        setFloat(uniforms.location(id), value);
+    }
+    void setFloat(GLint location, float value) const
+    {
+        glUniform1f(location, value);
     }
     // ------------------------------------------------------------------------
     void setVec2(const std::string &name, const glm::vec2 &value) const
-    { 
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+    {
+        setVec2(uniforms.location(name), value);
+    }
+    void setVec2(UniformId id, const glm::vec2 &value) const
+    {
+        setVec2(uniforms.location(id), value);
+    }
+    void setVec2(GLint location, const glm::vec2 &value) const
+    {
+        glUniform2fv(location, 1, &value[0]);
     }
     void setVec2(const std::string &name, float x, float y) const
-    { 
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y); 
+    {
+        setVec2(uniforms.location(name), x, y);
+    }
+    void setVec2(UniformId id, float x, float y) const
+    {
+        setVec2(uniforms.location(id), x, y);
+    }
+    void setVec2(GLint location, float x, float y) const
+    {
+        glUniform2f(location, x, y);
     }
     // ------------------------------------------------------------------------
     void setVec3(const std::string &name, const glm::vec3 &value) const
-    { 
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+    {
+        setVec3(uniforms.location(name), value);
+    }
+    void setVec3(UniformId id, const glm::vec3 &value) const
+    {
+        setVec3(uniforms.location(id), value);
+    }
+    void setVec3(GLint location, const glm::vec3 &value) const
+    {
+        glUniform3fv(location, 1, &value[0]);
     }
     void setVec3(const std::string &name, float x, float y, float z) const
-    { 
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z); 
+    {
+        setVec3(uniforms.location(name), x, y, z);
+    }
+    void setVec3(UniformId id, float x, float y, float z) const
+    {
+        setVec3(uniforms.location(id), x, y, z);
+    }
+    void setVec3(GLint location, float x, float y, float z) const
+    {
+        glUniform3f(location, x, y, z);
     }
     // ------------------------------------------------------------------------
     void setVec4(const std::string &name, const glm::vec4 &value) const
-    { 
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]); 
+    {
+        setVec4(uniforms.location(name), value);
+    }
+    void setVec4(UniformId id, const glm::vec4 &value) const
+    {
+        setVec4(uniforms.location(id), value);
+    }
+    void setVec4(GLint location, const glm::vec4 &value) const
+    {
+        glUniform4fv(location, 1, &value[0]);
     }
     void setVec4(const std::string &name, float x, float y, float z, float w) const
-    { 
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w); 
+    {
+        setVec4(uniforms.location(name), x, y, z, w);
+    }
+    void setVec4(UniformId id, float x, float y, float z, float w) const
+    {
+        setVec4(uniforms.location(id), x, y, z, w);
+    }
+    void setVec4(GLint location, float x, float y, float z, float w) const
+    {
+        glUniform4f(location, x, y, z, w);
     }
     // ------------------------------------------------------------------------
     void setMat2(const std::string &name, const glm::mat2 &mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat2(uniforms.location(name), mat);
+    }
+    void setMat2(UniformId id, const glm::mat2 &mat) const
+    {
+        setMat2(uniforms.location(id), mat);
+    }
+    void setMat2(GLint location, const glm::mat2 &mat) const
+    {
+        glUniformMatrix2fv(location, 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat3(const std::string &name, const glm::mat3 &mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat3(uniforms.location(name), mat);
+    }
+    void setMat3(UniformId id, const glm::mat3 &mat) const
+    {
+        setMat3(uniforms.location(id), mat);
+    }
+    void setMat3(GLint location, const glm::mat3 &mat) const
+    {
+        glUniformMatrix3fv(location, 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat4(const std::string &name, const glm::mat4 &mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        setMat4(uniforms.location(name), mat);
+    }
+    void setMat4(UniformId id, const glm::mat4 &mat) const
+    {
+        setMat4(uniforms.location(id), mat);
+    }
+    void setMat4(GLint location, const glm::mat4 &mat) const
+    {
+        glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
     }
 
 private:
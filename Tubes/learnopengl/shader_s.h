@@ -3,6 +3,11 @@
 
 #include <glad/glad.h>
 
+#include <learnopengl/camera_block.h>
+#include <learnopengl/gl_state.h>
+#include <learnopengl/program_cache.h>
+#include <learnopengl/uniform_table.h>
+
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -12,6 +17,7 @@ class Shader
 {
 public:
     unsigned int ID;
+    UniformTable uniforms;  // active uniform locations, read once the program is linked
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath)
@@ -46,7 +52,16 @@ public:
         }
         const char* vShaderCode = vertexCode.c_str();
         const char * fShaderCode = fragmentCode.c_str();
-        // 2. compile shaders
+        // 2. restore the linked program from the cache if it was built before
+        uint64_t cacheKey = programCacheKey({ &vertexCode, &fragmentCode });
+        ID = loadCachedProgram(cacheKey);
+        if (ID != 0)
+        {
+            uniforms.build(ID);
+            bindCameraBlock(ID);
+            return;
+        }
+        // 3. compile shaders
         unsigned int vertex, fragment;
         // vertex shader
         vertex = glCreateShader(GL_VERTEX_SHADER);
@@ -60,10 +75,14 @@ public:
         checkCompileErrors(fragment, "FRAGMENT");
         // shader Program
         ID = glCreateProgram();
+        prepareProgramForCache(ID);
         glAttachShader(ID, vertex);
         glAttachShader(ID, fragment);
         glLinkProgram(ID);
         checkCompileErrors(ID, "PROGRAM");
+        storeCachedProgram(cacheKey, ID);
+        uniforms.build(ID);
+        bindCameraBlock(ID);
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
@@ -72,23 +91,47 @@ public:
     // ------------------------------------------------------------------------
     void use() 
     { 
-        glUseProgram(ID); 
+        glState.useProgram(ID);
     }
     // utility uniform functions
     // ------------------------------------------------------------------------
     void setBool(const std::string &name, bool value) const
-    {         
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); 
+    {
+        setBool(uniforms.location(name), value);
+    }
+    void setBool(UniformId id, bool value) const
+    {
+        setBool(uniforms.location(id), value);
+    }
+    void setBool(GLint location, bool value) const
+    {
+        glUniform1i(location, (int)value);
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string &name, int value) const
-    { 
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value); 
+    {
+        setInt(uniforms.location(name), value);
+    }
+    void setInt(UniformId id, int value) const
+    {
+        setInt(uniforms.location(id), value);
+    }
+    void setInt(GLint location, int value) const
+    {
+        glUniform1i(location, value);
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string &name, float value) const
-    { 
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value); 
+    {
+        setFloat(uniforms.location(name), value);
+    }
+    void setFloat(UniformId id, float value) const
+    {
+        setFloat(uniforms.location(id), value);
+    }
+    void setFloat(GLint location, float value) const
+    {
+        glUniform1f(location, value);
     }
 
 private:
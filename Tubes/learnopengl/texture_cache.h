@@ -0,0 +1,456 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// S3TC is an extension to core 3.3, the loader may not define its enums
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+// GPU-ready texture: a BC1 (opaque) or BC3 (with alpha) mip chain, level 0 first; or
+// plain RGBA8 levels (format GL_RGBA8) where the driver has no S3TC
+struct CompressedImage {
+    struct Level {
+        int      width;
+        int      height;
+        uint32_t offset;    // bytes into data
+        uint32_t size;
+    };
+    GLenum format = 0;      // GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT or GL_RGBA8
+    std::vector<Level> levels;
+    std::vector<unsigned char> data;
+
+    int width() const { return levels.empty() ? 0 : levels[0].width; }
+    int height() const { return levels.empty() ? 0 : levels[0].height; }
+    bool compressed() const { return format != GL_RGBA8; }
+};
+
+namespace bc {
+
+inline uint16_t packColor565(int r, int g, int b)
+{
+    return static_cast<uint16_t>(((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 | ((b * 31 + 127) / 255));
+}
+
+inline void unpackColor565(uint16_t c, int rgb[3])
+{
+    rgb[0] = ((c >> 11) & 31) * 255 / 31;
+    rgb[1] = ((c >> 5) & 63) * 255 / 63;
+    rgb[2] = (c & 31) * 255 / 31;
+}
+
+// BC1 color block of 16 RGBA pixels: endpoints from the inset bounding box of the
+// block (flipped along red/blue when they run against green), always 4-color mode
+inline void encodeColorBlock(const unsigned char block[16][4], unsigned char out[8])
+{
+    int minC[3] = { 255, 255, 255 }, maxC[3] = { 0, 0, 0 }, mean[3] = { 0, 0, 0 };
+    for (int p = 0; p < 16; p++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            minC[k] = std::min(minC[k], int(block[p][k]));
+            maxC[k] = std::max(maxC[k], int(block[p][k]));
+            mean[k] += block[p][k];
+        }
+    }
+    int covRG = 0, covBG = 0;
+    for (int p = 0; p < 16; p++)
+    {
+        int g = block[p][1] * 16 - mean[1];
+        covRG += (block[p][0] * 16 - mean[0]) * g;
+        covBG += (block[p][2] * 16 - mean[2]) * g;
+    }
+    int c0[3], c1[3];
+    for (int k = 0; k < 3; k++)
+    {
+        int inset = (maxC[k] - minC[k]) / 16;
+        c0[k] = maxC[k] - inset;
+        c1[k] = minC[k] + inset;
+    }
+    if (covRG < 0)
+        std::swap(c0[0], c1[0]);
+    if (covBG < 0)
+        std::swap(c0[2], c1[2]);
+
+    uint16_t e0 = packColor565(c0[0], c0[1], c0[2]);
+    uint16_t e1 = packColor565(c1[0], c1[1], c1[2]);
+    if (e0 < e1)
+        std::swap(e0, e1);
+
+    uint32_t indices = 0;
+    if (e0 != e1)
+    {
+        int palette[4][3];
+        unpackColor565(e0, palette[0]);
+        unpackColor565(e1, palette[1]);
+        for (int k = 0; k < 3; k++)
+        {
+            palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+            palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+        }
+        for (int p = 0; p < 16; p++)
+        {
+            int best = 0, bestDistance = 1 << 30;
+            for (int i = 0; i < 4; i++)
+            {
+                int dr = block[p][0] - palette[i][0], dg = block[p][1] - palette[i][1], db = block[p][2] - palette[i][2];
+                int distance = dr * dr + dg * dg + db * db;
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    best = i;
+                }
+            }
+            indices |= uint32_t(best) << (2 * p);
+        }
+    }
+    out[0] = e0 & 0xFF; out[1] = e0 >> 8;
+    out[2] = e1 & 0xFF; out[3] = e1 >> 8;
+    for (int i = 0; i < 4; i++)
+        out[4 + i] = (indices >> (8 * i)) & 0xFF;
+}
+
+// BC3 alpha block: endpoints are the block's alpha range, 8-value mode
+inline void encodeAlphaBlock(const unsigned char block[16][4], unsigned char out[8])
+{
+    int a0 = 0, a1 = 255;
+    for (int p = 0; p < 16; p++)
+    {
+        a0 = std::max(a0, int(block[p][3]));
+        a1 = std::min(a1, int(block[p][3]));
+    }
+    uint64_t indices = 0;
+    if (a0 != a1)
+    {
+        int palette[8] = { a0, a1 };
+        for (int i = 1; i < 7; i++)
+            palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+        for (int p = 0; p < 16; p++)
+        {
+            int best = 0;
+            for (int i = 1; i < 8; i++)
+            {
+                if (std::abs(block[p][3] - palette[i]) < std::abs(block[p][3] - palette[best]))
+                    best = i;
+            }
+            indices |= uint64_t(best) << (3 * p);
+        }
+    }
+    out[0] = static_cast<unsigned char>(a0);
+    out[1] = static_cast<unsigned char>(a1);
+    for (int i = 0; i < 6; i++)
+        out[2 + i] = (indices >> (8 * i)) & 0xFF;
+}
+
+// encodes one RGBA8 image, edge pixels are repeated into partial blocks
+inline void encodeImage(const unsigned char* rgba, int width, int height, bool withAlpha, unsigned char* out)
+{
+    unsigned char block[16][4];
+    for (int by = 0; by < height; by += 4)
+    {
+        for (int bx = 0; bx < width; bx += 4)
+        {
+            for (int p = 0; p < 16; p++)
+            {
+                int x = std::min(bx + (p & 3), width - 1);
+                int y = std::min(by + (p >> 2), height - 1);
+                std::memcpy(block[p], rgba + (size_t(y) * width + x) * 4, 4);
+            }
+            if (withAlpha)
+            {
+                encodeAlphaBlock(block, out);
+                out += 8;
+            }
+            encodeColorBlock(block, out);
+            out += 8;
+        }
+    }
+}
+
+// 2x2 box filter, a 1 pixel wide side stays 1 pixel
+inline std::vector<unsigned char> downsample(const std::vector<unsigned char>& rgba, int width, int height)
+{
+    int w = std::max(1, width / 2), h = std::max(1, height / 2);
+    std::vector<unsigned char> out(size_t(w) * h * 4);
+    for (int y = 0; y < h; y++)
+    {
+        int y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+        for (int x = 0; x < w; x++)
+        {
+            int x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+            for (int k = 0; k < 4; k++)
+            {
+                int sum = rgba[(size_t(y0) * width + x0) * 4 + k] + rgba[(size_t(y0) * width + x1) * 4 + k] +
+                          rgba[(size_t(y1) * width + x0) * 4 + k] + rgba[(size_t(y1) * width + x1) * 4 + k];
+                out[(size_t(y) * w + x) * 4 + k] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+    return out;
+}
+
+} // namespace bc
+
+// Builds the full mip chain of an RGBA8 image and block-compresses every level: BC3
+// if any pixel isn't opaque, else BC1 (8:1 against the RGBA8 the driver would store).
+// Without compress the levels stay RGBA8.
+inline CompressedImage compressImage(const unsigned char* rgba, int width, int height, bool compress = true)
+{
+    bool withAlpha = false;
+    for (size_t i = 0; i < size_t(width) * height && !withAlpha; i++)
+        withAlpha = rgba[i * 4 + 3] != 255;
+
+    CompressedImage image;
+    image.format = !compress ? GL_RGBA8 : withAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+    const uint32_t blockBytes = withAlpha ? 16 : 8;
+
+    std::vector<unsigned char> level(rgba, rgba + size_t(width) * height * 4);
+    for (;;)
+    {
+        CompressedImage::Level info;
+        info.width = width;
+        info.height = height;
+        info.offset = static_cast<uint32_t>(image.data.size());
+        info.size = compress ? uint32_t((width + 3) / 4) * uint32_t((height + 3) / 4) * blockBytes : uint32_t(width) * uint32_t(height) * 4;
+        image.levels.push_back(info);
+        image.data.resize(info.offset + info.size);
+        if (compress)
+            bc::encodeImage(level.data(), width, height, withAlpha, image.data.data() + info.offset);
+        else
+            std::memcpy(image.data.data() + info.offset, level.data(), info.size);
+
+        if (width == 1 && height == 1)
+            break;
+        level = bc::downsample(level, width, height);
+        width = std::max(1, width / 2);
+        height = std::max(1, height / 2);
+    }
+    return image;
+}
+
+// true if the driver takes the S3TC (BC1/BC3) formats; checked once at startup, the
+// TextureCache falls back to RGBA8 without them
+inline bool textureCompressionSupported()
+{
+    GLint extensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &extensions);
+    for (GLint i = 0; i < extensions; i++)
+    {
+        if (std::strcmp(reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i)), "GL_EXT_texture_compression_s3tc") == 0)
+            return true;
+    }
+    return false;
+}
+
+// specifies level i of image on target of the bound texture; pixels points at the
+// level's bytes, or is their offset into the bound GL_PIXEL_UNPACK_BUFFER
+inline void specifyImageLevel(GLenum target, const CompressedImage& image, size_t i, const void* pixels)
+{
+    const CompressedImage::Level& level = image.levels[i];
+    if (image.compressed())
+        glCompressedTexImage2D(target, static_cast<GLint>(i), image.format, level.width, level.height, 0, static_cast<GLsizei>(level.size), pixels);
+    else
+        glTexImage2D(target, static_cast<GLint>(i), GL_RGBA8, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+}
+
+// uploads every level to target (GL_TEXTURE_2D or a cubemap face) of the bound texture
+inline void uploadCompressedImage(GLenum target, const CompressedImage& image)
+{
+    for (size_t i = 0; i < image.levels.size(); i++)
+        specifyImageLevel(target, image, i, image.data.data() + image.levels[i].offset);
+}
+
+// Persistent on-disk cache of compressed images, keyed by a hash of the source file's
+// bytes, so an edited image is recompressed and an unchanged one is never decoded
+// again. Safe to use from several threads at once.
+class TextureCache
+{
+public:
+    // same signatures as stbi_load_from_memory and stbi_image_free
+    typedef unsigned char* (*DecodeFunc)(const unsigned char* bytes, int size, int* width, int* height, int* channels, int desiredChannels);
+    typedef void (*FreeFunc)(void* pixels);
+
+    std::atomic<unsigned int> hits{0};
+    std::atomic<unsigned int> misses{0};
+
+    TextureCache(const std::string& directory, DecodeFunc decode, FreeFunc free)
+        : m_directory(directory), m_decode(decode), m_free(free)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(m_directory, error);
+    }
+
+    // BC1/BC3 output, on by default; set once at startup from
+    // textureCompressionSupported(), before anything loads
+    void setCompression(bool compress)
+    {
+        m_compress = compress;
+    }
+
+    // loads the compressed image for the file at path, decoding and compressing it
+    // only on a cache miss. flip mirrors the image vertically (OpenGL's origin).
+    bool load(const std::string& path, bool flip, CompressedImage& image)
+    {
+        std::vector<unsigned char> source;
+        if (!readFile(path, source))
+        {
+            std::cout << "ERROR::TEXTURE_CACHE::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+            return false;
+        }
+        const uint64_t key = sourceKey(source, flip, m_compress);
+        const std::string entry = entryPath(key);
+        if (readEntry(entry, key, image))
+        {
+            hits++;
+            return true;
+        }
+
+        int width, height, channels;
+        unsigned char* pixels = m_decode(source.data(), static_cast<int>(source.size()), &width, &height, &channels, 4);
+        if (!pixels)
+        {
+            std::cout << "ERROR::TEXTURE_CACHE::DECODE_FAILED: " << path << std::endl;
+            return false;
+        }
+        if (flip)
+        {
+            std::vector<unsigned char> row(size_t(width) * 4);
+            for (int y = 0; y < height / 2; y++)
+            {
+                unsigned char* top = pixels + size_t(y) * width * 4;
+                unsigned char* bottom = pixels + size_t(height - 1 - y) * width * 4;
+                std::memcpy(row.data(), top, row.size());
+                std::memcpy(top, bottom, row.size());
+                std::memcpy(bottom, row.data(), row.size());
+            }
+        }
+        image = compressImage(pixels, width, height, m_compress);
+        m_free(pixels);
+        misses++;
+
+        if (!writeEntry(entry, key, image))
+            std::cout << "ERROR::TEXTURE_CACHE::WRITE_FAILED: " << entry << std::endl;
+        return true;
+    }
+
+private:
+    static const uint32_t MAGIC = 0x58455442; // "BTEX"
+    static const uint32_t VERSION = 1;        // bump when the encoder or layout changes
+
+    struct EntryHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t format;
+        uint32_t levelCount;
+        uint32_t dataSize;
+        uint32_t reserved;
+    };
+
+    std::string m_directory;
+    DecodeFunc m_decode;
+    FreeFunc m_free;
+    bool m_compress = true;
+    std::atomic<unsigned int> m_tempCounter{0};
+
+    static bool readFile(const std::string& path, std::vector<unsigned char>& bytes)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file)
+            return false;
+        bytes.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+        return static_cast<bool>(file);
+    }
+
+    // FNV-1a over the source bytes, the flip flag, the uncompressed fallback (mixed in
+    // only when on, so compressed entries keep their keys) and the cache version
+    static uint64_t sourceKey(const std::vector<unsigned char>& bytes, bool flip, bool compress)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (unsigned char b : bytes)
+            hash = (hash ^ b) * 1099511628211ull;
+        hash = (hash ^ (flip ? 1u : 0u)) * 1099511628211ull;
+        if (!compress)
+            hash = (hash ^ GL_RGBA8) * 1099511628211ull;
+        return (hash ^ VERSION) * 1099511628211ull;
+    }
+
+    std::string entryPath(uint64_t key) const
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.btex", static_cast<unsigned long long>(key));
+        return m_directory + "/" + name;
+    }
+
+    // a missing, stale or truncated entry is a miss
+    static bool readEntry(const std::string& path, uint64_t key, CompressedImage& image)
+    {
+        std::ifstream file(path, std::ios::binary);
+        EntryHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+            return false;
+        if (header.magic != MAGIC || header.version != VERSION || header.key != key || header.levelCount == 0 || header.levelCount > 32)
+            return false;
+        image.format = header.format;
+        image.levels.resize(header.levelCount);
+        image.data.resize(header.dataSize);
+        file.read(reinterpret_cast<char*>(image.levels.data()), image.levels.size() * sizeof(CompressedImage::Level));
+        file.read(reinterpret_cast<char*>(image.data.data()), image.data.size());
+        if (!file)
+            return false;
+        for (const CompressedImage::Level& level : image.levels)
+        {
+            if (uint64_t(level.offset) + level.size > image.data.size())
+                return false;
+        }
+        return true;
+    }
+
+    // written to a temporary file first, so a reader never sees half an entry
+    bool writeEntry(const std::string& path, uint64_t key, const CompressedImage& image)
+    {
+        EntryHeader header;
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.key = key;
+        header.format = image.format;
+        header.levelCount = static_cast<uint32_t>(image.levels.size());
+        header.dataSize = static_cast<uint32_t>(image.data.size());
+        header.reserved = 0;
+
+        const std::string temp = path + ".tmp" + std::to_string(m_tempCounter++);
+        {
+            std::ofstream file(temp, std::ios::binary);
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(image.levels.data()), image.levels.size() * sizeof(CompressedImage::Level));
+            file.write(reinterpret_cast<const char*>(image.data.data()), image.data.size());
+            if (!file)
+                return false;
+        }
+        std::error_code error;
+        std::filesystem::rename(temp, path, error);
+        if (!error)
+            return true;
+        std::filesystem::remove(temp, error);
+        return false;
+    }
+};
+#endif
@@ -0,0 +1,165 @@
+#ifndef TEXTURE_REGISTRY_H
+#define TEXTURE_REGISTRY_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/gl_state.h>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+class TextureRegistry;
+
+// One reference to a registered texture; the texture is deleted when the last handle
+// to it goes away. Move-only, so whoever holds it (a Model) owns exactly one reference.
+class TextureHandle
+{
+public:
+    TextureHandle() = default;
+    TextureHandle(TextureRegistry* registry, std::string key, unsigned int id) : m_registry(registry), m_key(std::move(key)), m_id(id) {}
+    TextureHandle(const TextureHandle&) = delete;
+    TextureHandle& operator=(const TextureHandle&) = delete;
+    TextureHandle(TextureHandle&& other) noexcept { swap(other); }
+    TextureHandle& operator=(TextureHandle&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            swap(other);
+        }
+        return *this;
+    }
+    ~TextureHandle() { reset(); }
+
+    unsigned int id() const { return m_id; }
+    const std::string& key() const { return m_key; }
+
+    inline void reset();
+
+private:
+    TextureRegistry* m_registry = nullptr;
+    std::string m_key;
+    unsigned int m_id = 0;
+
+    void swap(TextureHandle& other)
+    {
+        std::swap(m_registry, other.m_registry);
+        std::swap(m_key, other.m_key);
+        std::swap(m_id, other.m_id);
+    }
+};
+
+// Process-wide table of loaded textures, keyed by normalized absolute path, so every
+// Model that names the same file shares one GL texture. acquire() and release are
+// safe from any thread: a texture is loaded once by the first caller that asks for it
+// and everyone else asking meanwhile waits for that load. The load function runs on
+// the acquiring thread, and the texture is deleted on the thread dropping its last
+// handle, so whichever of those touch GL have to be the GL thread.
+class TextureRegistry
+{
+public:
+    typedef std::function<unsigned int()> LoadFunc;
+
+    // path as the registry keys it: absolute, "." and ".." resolved, '/' separated
+    // (and lowercase on Windows, whose paths don't care about case)
+    static std::string normalizePath(const std::string& path)
+    {
+        std::error_code error;
+        std::filesystem::path absolute = std::filesystem::absolute(path, error);
+        std::string key = (error ? std::filesystem::path(path) : absolute).lexically_normal().generic_string();
+#ifdef _WIN32
+        std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+#endif
+        return key;
+    }
+
+    TextureHandle acquire(const std::string& path, const LoadFunc& load)
+    {
+        std::string key = normalizePath(path);
+        std::shared_future<unsigned int> texture;
+        std::promise<unsigned int> loading;
+        bool loadHere = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto found = m_entries.find(key);
+            if (found == m_entries.end())
+            {
+                found = m_entries.emplace(key, Entry{ loading.get_future().share(), 0 }).first;
+                loadHere = true;
+                m_misses++;
+            }
+            else
+                m_hits++;
+            found->second.references++;
+            texture = found->second.texture;
+        }
+        if (loadHere)
+            loading.set_value(load());
+        return TextureHandle(this, key, texture.get());
+    }
+
+    // textures currently registered
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+    // acquires answered from the registry and ones that had to load
+    unsigned int hits() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_hits;
+    }
+
+    unsigned int misses() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_misses;
+    }
+
+private:
+    friend class TextureHandle;
+
+    struct Entry {
+        std::shared_future<unsigned int> texture;
+        unsigned int references;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, Entry> m_entries;
+    unsigned int m_hits = 0;
+    unsigned int m_misses = 0;
+
+    void release(const std::string& key, unsigned int id)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto found = m_entries.find(key);
+            if (found == m_entries.end() || --found->second.references > 0)
+                return;
+            m_entries.erase(found);
+        }
+        if (id != 0)
+            glState.deleteTexture(id);
+    }
+};
+
+inline void TextureHandle::reset()
+{
+    if (m_registry)
+        m_registry->release(m_key, m_id);
+    m_registry = nullptr;
+    m_key.clear();
+    m_id = 0;
+}
+
+inline TextureRegistry textureRegistry;
+#endif
@@ -0,0 +1,344 @@
+#ifndef TEXTURE_UPLOAD_H
+#define TEXTURE_UPLOAD_H
+
+#include <glad/glad.h>
+
+#include <learnopengl/gl_state.h>
+#include <learnopengl/texture_cache.h>
+#include <learnopengl/thread_pool.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const unsigned int NO_TEXTURE_UPLOAD = 0xFFFFFFFFu;
+
+// Streams textures to the GPU without stalling the frame. Workers load every image
+// through the TextureCache (a cached one is just a file read), and update() copies
+// finished images into a staging pixel buffer, at most frameBudget bytes per frame,
+// and specifies the texture levels from there. A fence per upload tells when its
+// staging space can be reused and when the texture is resident; until then texture()
+// hands out a 1x1 placeholder, so nothing waits on a load.
+//
+// GL 3.3 has no persistent mapping and a buffer can't feed an upload while mapped,
+// so the staging ring is mapped unsynchronized for each copy (the fences already keep
+// it off data still in flight) rather than workers writing into a standing mapping.
+class TextureUploadQueue
+{
+public:
+    TextureUploadQueue(ThreadPool& workers, TextureCache& cache) : m_workers(workers), m_cache(cache) {}
+
+    TextureUploadQueue(const TextureUploadQueue&) = delete;
+    TextureUploadQueue& operator=(const TextureUploadQueue&) = delete;
+
+    // placeholders are 0xRRGGBBAA colors for 2D textures and cubemaps
+    void create(size_t stagingBytes = 16 << 20, size_t frameBudget = 4 << 20, uint32_t placeholder2D = 0xFFFFFFFF, uint32_t placeholderCube = 0x808080FF)
+    {
+        m_capacity = stagingBytes;
+        m_frameBudget = frameBudget;
+        glGenBuffers(1, &m_staging);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_staging);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, m_capacity, NULL, GL_STREAM_DRAW);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        m_placeholder2D = createPlaceholder(GL_TEXTURE_2D, placeholder2D);
+        m_placeholderCube = createPlaceholder(GL_TEXTURE_CUBE_MAP, placeholderCube);
+    }
+
+    // waits for outstanding loads and frees the staging buffer, the placeholders and
+    // every texture that wasn't released
+    void destroy()
+    {
+        for (Job& job : m_jobs)
+        {
+            if (!job.collected)
+                job.image.wait();
+        }
+        m_jobs.clear();
+        for (InFlight& upload : m_inFlight)
+            glDeleteSync(upload.fence);
+        m_inFlight.clear();
+        for (Entry& entry : m_entries)
+        {
+            if (!entry.released)
+                glState.deleteTexture(entry.texture);
+            entry.released = true;
+        }
+        glState.deleteTexture(m_placeholder2D);
+        glState.deleteTexture(m_placeholderCube);
+        glDeleteBuffers(1, &m_staging);
+        m_staging = 0;
+    }
+
+    // Queues the images of a GL_TEXTURE_2D (one path) or GL_TEXTURE_CUBE_MAP (six
+    // paths, +X -X +Y -Y +Z -Z) and returns its id. flip mirrors the images vertically.
+    unsigned int request(GLenum target, const std::vector<std::string>& paths, bool flip)
+    {
+        Entry entry;
+        entry.target = target;
+        entry.images = static_cast<unsigned int>(paths.size());
+        glGenTextures(1, &entry.texture);
+        glState.bindTexture(0, target, entry.texture);
+        const GLint wrap = target == GL_TEXTURE_CUBE_MAP ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, wrap);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, wrap);
+        glTexParameteri(target, GL_TEXTURE_WRAP_R, wrap);
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, target == GL_TEXTURE_CUBE_MAP ? GL_LINEAR : GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        const unsigned int id = static_cast<unsigned int>(m_entries.size());
+        m_entries.push_back(entry);
+        for (size_t i = 0; i < paths.size(); i++)
+        {
+            Job job;
+            job.entry = id;
+            job.imageTarget = target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<GLenum>(i) : target;
+            job.path = paths[i];
+            TextureCache* cache = &m_cache;
+            job.image = m_workers.submit([cache, path = paths[i], flip] {
+                LoadedImage loaded;
+                loaded.ok = cache->load(path, flip, loaded.image);
+                return loaded;
+            });
+            m_jobs.push_back(std::move(job));
+        }
+        return id;
+    }
+
+    bool isResident(unsigned int id) const
+    {
+        return id < m_entries.size() && !m_entries[id].released && !m_entries[id].failed && m_entries[id].retired == m_entries[id].images;
+    }
+
+    // the texture to bind for id: the real one once resident, the placeholder before
+    unsigned int texture(unsigned int id) const
+    {
+        if (isResident(id))
+            return m_entries[id].texture;
+        GLenum target = id < m_entries.size() ? m_entries[id].target : GL_TEXTURE_2D;
+        return target == GL_TEXTURE_CUBE_MAP ? m_placeholderCube : m_placeholder2D;
+    }
+
+    // deletes the texture; images of it still loading are dropped when they arrive
+    void release(unsigned int id)
+    {
+        if (id >= m_entries.size() || m_entries[id].released)
+            return;
+        glState.deleteTexture(m_entries[id].texture);
+        m_entries[id].released = true;
+    }
+
+    // Call once per frame on the GL thread: retires finished uploads and uploads
+    // loaded images until the frame's byte budget or the staging buffer runs out.
+    // One image is always allowed per frame, so an image over the budget still lands.
+    void update()
+    {
+        retireFinishedUploads();
+
+        size_t uploadedBytes = 0;
+        for (auto job = m_jobs.begin(); job != m_jobs.end();)
+        {
+            if (!job->collected)
+            {
+                if (job->image.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                {
+                    ++job;
+                    continue;
+                }
+                job->loaded = job->image.get();
+                job->collected = true;
+            }
+            Entry& entry = m_entries[job->entry];
+            if (entry.released)
+            {
+                job = m_jobs.erase(job);
+                continue;
+            }
+            if (!job->loaded.ok)
+            {
+                std::cout << "ERROR::TEXTURE_UPLOAD::LOAD_FAILED: " << job->path << std::endl;
+                entry.failed = true;    // keeps the placeholder
+                job = m_jobs.erase(job);
+                continue;
+            }
+
+            const CompressedImage& image = job->loaded.image;
+            const size_t size = alignedSize(image.data.size());
+            if (uploadedBytes > 0 && uploadedBytes + size > m_frameBudget)
+                break;
+            size_t offset = 0;
+            const bool staged = size <= m_capacity && allocate(size, offset);
+            if (!staged && size <= m_capacity)
+                break;  // staging full of uploads in flight, try again next frame
+
+            glState.bindTexture(0, entry.target, entry.texture);
+            glTexParameteri(entry.target, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.levels.size()) - 1);
+            if (staged && stage(image, offset))
+            {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_staging);
+                for (size_t i = 0; i < image.levels.size(); i++)
+                    specifyImageLevel(job->imageTarget, image, i, reinterpret_cast<const void*>(offset + image.levels[i].offset));
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                m_inFlight.push_back({ offset, offset + size, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), job->entry });
+            }
+            else
+            {
+                // bigger than the whole staging buffer (or the map failed): straight from memory
+                uploadCompressedImage(job->imageTarget, image);
+                entry.retired++;
+            }
+            uploadedBytes += size;
+            m_uploadedBytes += image.data.size();
+            job = m_jobs.erase(job);
+        }
+    }
+
+    // bytes uploaded since create()
+    size_t uploadedBytes() const
+    {
+        return m_uploadedBytes;
+    }
+
+private:
+    struct LoadedImage {
+        CompressedImage image;
+        bool ok = false;
+    };
+
+    struct Job {
+        unsigned int entry;
+        GLenum imageTarget;
+        std::string path;
+        std::future<LoadedImage> image;
+        LoadedImage loaded;         // the future's result, once collected
+        bool collected = false;
+    };
+
+    struct Entry {
+        GLenum target;
+        GLuint texture = 0;
+        unsigned int images = 0;
+        unsigned int retired = 0;   // images whose upload finished on the GPU
+        bool released = false;
+        bool failed = false;        // an image didn't load
+    };
+
+    // staging range [begin, end) read by uploads that haven't finished yet
+    struct InFlight {
+        size_t begin;
+        size_t end;
+        GLsync fence;
+        unsigned int entry;
+    };
+
+    ThreadPool& m_workers;
+    TextureCache& m_cache;
+    GLuint m_staging = 0;
+    size_t m_capacity = 0;
+    size_t m_frameBudget = 0;
+    size_t m_head = 0;
+    size_t m_uploadedBytes = 0;
+    GLuint m_placeholder2D = 0;
+    GLuint m_placeholderCube = 0;
+    std::vector<Entry> m_entries;
+    std::deque<Job> m_jobs;
+    std::deque<InFlight> m_inFlight;
+
+    static size_t alignedSize(size_t size)
+    {
+        return (size + 15) & ~size_t(15);
+    }
+
+    GLuint createPlaceholder(GLenum target, uint32_t rgba)
+    {
+        const unsigned char pixel[4] = { static_cast<unsigned char>(rgba >> 24), static_cast<unsigned char>(rgba >> 16),
+                                         static_cast<unsigned char>(rgba >> 8), static_cast<unsigned char>(rgba) };
+        GLuint texture;
+        glGenTextures(1, &texture);
+        glState.bindTexture(0, target, texture);
+        glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        if (target == GL_TEXTURE_CUBE_MAP)
+        {
+            for (GLenum face = 0; face < 6; face++)
+                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+        }
+        else
+            glTexImage2D(target, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+        return texture;
+    }
+
+    void retireFinishedUploads()
+    {
+        while (!m_inFlight.empty())
+        {
+            GLint status = GL_UNSIGNALED;
+            glGetSynciv(m_inFlight.front().fence, GL_SYNC_STATUS, 1, NULL, &status);
+            if (status != GL_SIGNALED)
+                break;
+            glDeleteSync(m_inFlight.front().fence);
+            m_entries[m_inFlight.front().entry].retired++;
+            m_inFlight.pop_front();
+        }
+        if (m_inFlight.empty())
+            m_head = 0;
+    }
+
+    // finds size bytes of the ring that no upload in flight reads. Ranges are handed
+    // out in order, so the live ones run from the oldest in-flight begin to m_head.
+    bool allocate(size_t size, size_t& offset)
+    {
+        if (m_inFlight.empty())
+        {
+            offset = 0;
+            m_head = size;
+            return true;
+        }
+        const size_t tail = m_inFlight.front().begin;
+        if (m_head >= tail)
+        {
+            if (m_head + size <= m_capacity)
+            {
+                offset = m_head;
+                m_head += size;
+                return true;
+            }
+            if (size < tail)
+            {
+                offset = 0;
+                m_head = size;
+                return true;
+            }
+            return false;
+        }
+        if (m_head + size < tail)
+        {
+            offset = m_head;
+            m_head += size;
+            return true;
+        }
+        return false;
+    }
+
+    // copies the image into the staging range; unsynchronized is safe because the
+    // range isn't read by any upload still in flight
+    bool stage(const CompressedImage& image, size_t offset)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_staging);
+        void* destination = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, offset, image.data.size(),
+                                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (destination)
+        {
+            std::memcpy(destination, image.data.data(), image.data.size());
+            if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) != GL_TRUE)
+                destination = nullptr;  // contents lost, let the caller upload from memory
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return destination != nullptr;
+    }
+};
+#endif
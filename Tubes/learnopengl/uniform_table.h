@@ -0,0 +1,172 @@
+#ifndef UNIFORM_TABLE_H
+#define UNIFORM_TABLE_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// FNV-1a of a uniform name, usable at compile time
+constexpr uint32_t uniformHash(const char* name, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+        hash = (hash ^ static_cast<unsigned char>(name[i])) * 16777619u;
+    return hash;
+}
+
+// A uniform name hashed at compile time: "model"_uniform. Only made through the
+// literal, so a plain string still picks the std::string setters.
+struct UniformId {
+    uint32_t hash;
+    constexpr explicit UniformId(uint32_t hash) : hash(hash) {}
+};
+
+constexpr UniformId operator""_uniform(const char* name, size_t length)
+{
+    return UniformId(uniformHash(name, length));
+}
+
+// Every active uniform of a linked program and its location, read once with
+// glGetActiveUniform so setters never ask the driver for a location by name. Array
+// uniforms are listed by their base name and every "name[i]". Kept sorted by hash
+// in one flat vector; names that aren't active uniforms resolve to -1, which
+// glUniform* ignores just like it would for glGetUniformLocation's -1.
+// Every sampler (and sampler array element) also gets a texture unit of its own, in
+// the order the program lists them, so code that shares a program agrees on which
+// unit a sampler reads without talking to each other (see Mesh::Draw).
+class UniformTable
+{
+public:
+    void build(unsigned int program)
+    {
+        m_entries.clear();
+        m_samplerUnits = 0;
+        GLint count = 0, maxLength = 0;
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        std::vector<char> buffer(std::max(maxLength, 1));
+        for (GLint i = 0; i < count; i++)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(program, static_cast<GLuint>(i), static_cast<GLsizei>(buffer.size()), &length, &size, &type, buffer.data());
+            std::string name(buffer.data(), length);
+            GLint location = glGetUniformLocation(program, name.c_str());
+            if (location < 0)
+                continue;   // uniform block member
+            // arrays are reported as "name[0]"
+            GLint unit = isSamplerType(type) ? m_samplerUnits : -1;
+            std::string::size_type bracket = name.find('[');
+            if (bracket == std::string::npos)
+            {
+                add(name, location, unit);
+                m_samplerUnits += unit >= 0 ? 1 : 0;
+                continue;
+            }
+            std::string base = name.substr(0, bracket);
+            add(base, location, unit);
+            for (GLint element = 0; element < size; element++)
+            {
+                std::string elementName = base + "[" + std::to_string(element) + "]";
+                add(elementName, element == 0 ? location : glGetUniformLocation(program, elementName.c_str()), unit >= 0 ? unit + element : -1);
+            }
+            m_samplerUnits += unit >= 0 ? size : 0;
+        }
+        std::sort(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b) { return a.hash < b.hash; });
+        for (size_t i = 1; i < m_entries.size(); i++)
+        {
+            if (m_entries[i].hash == m_entries[i - 1].hash)
+                std::cout << "ERROR::UNIFORM_TABLE::HASH_COLLISION: " << m_entries[i - 1].name << " and " << m_entries[i].name
+                          << " (use the string setters for them)" << std::endl;
+        }
+    }
+
+    GLint location(UniformId id) const
+    {
+        const Entry* entry = find(id);
+        return entry ? entry->location : -1;
+    }
+
+    // slow path: hashes the name at runtime and compares it in full
+    GLint location(const std::string& name) const
+    {
+        const Entry* entry = find(name);
+        return entry ? entry->location : -1;
+    }
+
+    // texture unit given to a sampler uniform, -1 if the name isn't an active sampler.
+    // The sampler still has to be set to it once, with the program in use.
+    GLint samplerUnit(UniformId id) const
+    {
+        const Entry* entry = find(id);
+        return entry ? entry->unit : -1;
+    }
+
+    GLint samplerUnit(const std::string& name) const
+    {
+        const Entry* entry = find(name);
+        return entry ? entry->unit : -1;
+    }
+
+private:
+    struct Entry {
+        uint32_t hash;
+        GLint location;
+        GLint unit;         // texture unit of a sampler, -1 for everything else
+        std::string name;
+    };
+    std::vector<Entry> m_entries;
+    GLint m_samplerUnits = 0;
+
+    void add(const std::string& name, GLint location, GLint unit)
+    {
+        m_entries.push_back({ uniformHash(name.data(), name.size()), location, unit, name });
+    }
+
+    const Entry* find(UniformId id) const
+    {
+        auto found = std::lower_bound(m_entries.begin(), m_entries.end(), id.hash, [](const Entry& entry, uint32_t hash) { return entry.hash < hash; });
+        return (found != m_entries.end() && found->hash == id.hash) ? &*found : nullptr;
+    }
+
+    const Entry* find(const std::string& name) const
+    {
+        uint32_t hash = uniformHash(name.data(), name.size());
+        auto found = std::lower_bound(m_entries.begin(), m_entries.end(), hash, [](const Entry& entry, uint32_t hash) { return entry.hash < hash; });
+        for (; found != m_entries.end() && found->hash == hash; ++found)
+        {
+            if (found->name == name)
+                return &*found;
+        }
+        return nullptr;
+    }
+
+    // the sampler types of GL 3.3 core
+    static bool isSamplerType(GLenum type)
+    {
+        switch (type)
+        {
+        case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+        case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_SAMPLER_BUFFER:
+        case GL_SAMPLER_2D_RECT: case GL_SAMPLER_2D_RECT_SHADOW:
+        case GL_INT_SAMPLER_1D: case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_CUBE:
+        case GL_INT_SAMPLER_1D_ARRAY: case GL_INT_SAMPLER_2D_ARRAY: case GL_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_INT_SAMPLER_BUFFER: case GL_INT_SAMPLER_2D_RECT:
+        case GL_UNSIGNED_INT_SAMPLER_1D: case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D:
+        case GL_UNSIGNED_INT_SAMPLER_CUBE: case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE: case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_BUFFER: case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+            return true;
+        default:
+            return false;
+        }
+    }
+};
+#endif
@@ -0,0 +1,73 @@
+#ifndef VERTEX_WELD_H
+#define VERTEX_WELD_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Result of welding a non-indexed triangle list: every distinct vertex once, plus the
+// index list that rebuilds the original triangles from them.
+struct WeldedMesh {
+    std::vector<float>        vertices;
+    std::vector<unsigned int> indices;
+    unsigned int              floatsPerVertex = 0;
+
+    unsigned int vertexCount() const
+    {
+        return floatsPerVertex ? static_cast<unsigned int>(vertices.size() / floatsPerVertex) : 0;
+    }
+
+    // true when every index fits GL_UNSIGNED_SHORT
+    bool fitsShortIndices() const
+    {
+        return vertexCount() <= 0xFFFF;
+    }
+
+    std::vector<uint16_t> shortIndices() const
+    {
+        return std::vector<uint16_t>(indices.begin(), indices.end());
+    }
+};
+
+// Merges vertices whose floats (position, color, texture coords, ...) are bit-for-bit
+// identical. Uses an open addressing hash table over the vertex bytes, so welding is
+// linear in the number of input vertices. The first occurrence of a vertex keeps its
+// place, so the welded vertex order follows the original triangle order.
+inline WeldedMesh weldVertices(const float* vertices, size_t vertexCount, unsigned int floatsPerVertex)
+{
+    WeldedMesh mesh;
+    mesh.floatsPerVertex = floatsPerVertex;
+    mesh.indices.reserve(vertexCount);
+
+    const size_t vertexBytes = floatsPerVertex * sizeof(float);
+    size_t tableSize = 16;
+    while (tableSize < vertexCount * 2)
+        tableSize <<= 1;
+    const uint32_t EMPTY = 0xFFFFFFFFu;
+    std::vector<uint32_t> table(tableSize, EMPTY);
+
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        const float* vertex = vertices + v * floatsPerVertex;
+
+        // FNV-1a over the raw vertex bytes
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(vertex);
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t b = 0; b < vertexBytes; b++)
+            hash = (hash ^ bytes[b]) * 1099511628211ull;
+
+        size_t slot = static_cast<size_t>(hash) & (tableSize - 1);
+        while (table[slot] != EMPTY &&
+               std::memcmp(&mesh.vertices[size_t(table[slot]) * floatsPerVertex], vertex, vertexBytes) != 0)
+            slot = (slot + 1) & (tableSize - 1);
+
+        if (table[slot] == EMPTY)
+        {
+            table[slot] = mesh.vertexCount();
+            mesh.vertices.insert(mesh.vertices.end(), vertex, vertex + floatsPerVertex);
+        }
+        mesh.indices.push_back(table[slot]);
+    }
+    return mesh;
+}
+#endif
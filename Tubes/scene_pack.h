@@ -0,0 +1,201 @@
+#ifndef SCENE_PACK_H
+#define SCENE_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "learnopengl/mapped_file.h"
+
+// Binary scene pack written by tools/pack_scene.cpp. Layout of a pack file:
+//   ScenePackHeader
+//   ScenePackObject[objectCount]
+//   per object: welded PackedVertex blob, then its index blob (16 or 32 bit triangle
+//   list), each starting on a SCENE_PACK_ALIGNMENT boundary
+// All values are little-endian, offsets are in bytes from the start of the file.
+const uint32_t SCENE_PACK_MAGIC     = 0x4B415053; // "SPAK"
+const uint32_t SCENE_PACK_VERSION   = 3;
+const uint32_t SCENE_PACK_ALIGNMENT = 64;
+const uint32_t SCENE_PACK_NAME_SIZE = 32;
+
+struct ScenePackHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t objectCount;
+    uint32_t vertexStride;  // bytes per vertex, sizeof(PackedVertex)
+    uint64_t fileSize;
+};
+
+struct ScenePackObject {
+    char     name[SCENE_PACK_NAME_SIZE];
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexSize;     // 2 (GL_UNSIGNED_SHORT) or 4 (GL_UNSIGNED_INT) bytes
+    uint32_t reserved;
+    // object space bounds of the vertex positions, also the range they're quantized to
+    float    boundsMin[3];
+    float    boundsMax[3];
+};
+
+// Compact static vertex: the hand-authored texture coords were always 0.0 and are
+// dropped, the color becomes RGBA8 and the position is quantized to 16 bits over the
+// object's bounds. 7.4.camera.vs dequantizes with boundsMin[object] + aPos * boundsSize[object].
+struct PackedVertex {
+    uint16_t position[3];   // GL_UNSIGNED_SHORT, normalized
+    uint16_t object;        // GL_UNSIGNED_SHORT, integer: index of the object's bounds
+    uint8_t  color[4];      // GL_UNSIGNED_BYTE, normalized
+};
+
+static_assert(sizeof(ScenePackHeader) == 24, "ScenePackHeader layout changed");
+static_assert(sizeof(ScenePackObject) == 88, "ScenePackObject layout changed");
+static_assert(sizeof(PackedVertex) == 12, "PackedVertex layout changed");
+
+inline uint64_t alignScenePackOffset(uint64_t offset)
+{
+    return (offset + SCENE_PACK_ALIGNMENT - 1) & ~uint64_t(SCENE_PACK_ALIGNMENT - 1);
+}
+
+// A scene pack mapped into memory. Vertex and index blobs are handed to glBufferData
+// straight out of the mapping, so nothing is parsed or copied on the CPU.
+class ScenePack
+{
+public:
+    bool load(const char* path)
+    {
+        if (!m_file.open(path))
+        {
+            std::cout << "ERROR::SCENE_PACK::FILE_NOT_SUCCESFULLY_READ: " << path << std::endl;
+            return false;
+        }
+        if (!validate())
+        {
+            std::cout << "ERROR::SCENE_PACK::INVALID_FILE: " << path << " (re-run tools/pack_scene)" << std::endl;
+            m_file.close();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+        m_file.close();
+    }
+
+    unsigned int objectCount() const
+    {
+        return header().objectCount;
+    }
+
+    unsigned int vertexStride() const
+    {
+        return header().vertexStride;
+    }
+
+    const ScenePackObject& object(unsigned int i) const
+    {
+        return objects()[i];
+    }
+
+    // returns the object index with the given name, or -1 if the pack doesn't have it
+    int find(const char* name) const
+    {
+        for (unsigned int i = 0; i < objectCount(); i++)
+        {
+            if (std::strncmp(objects()[i].name, name, SCENE_PACK_NAME_SIZE) == 0)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    const void* vertexData(unsigned int i) const
+    {
+        return m_file.data() + object(i).vertexOffset;
+    }
+
+    size_t vertexBytes(unsigned int i) const
+    {
+        return static_cast<size_t>(object(i).vertexCount) * vertexStride();
+    }
+
+    const void* indexData(unsigned int i) const
+    {
+        return m_file.data() + object(i).indexOffset;
+    }
+
+    size_t indexBytes(unsigned int i) const
+    {
+        return static_cast<size_t>(object(i).indexCount) * object(i).indexSize;
+    }
+
+    // CPU copies for the code that reads the geometry itself (occlusion culling):
+    // dequantized xyz positions, three floats per vertex
+    void positions(unsigned int i, std::vector<float>& xyz) const
+    {
+        const ScenePackObject& o = object(i);
+        const PackedVertex* vertices = static_cast<const PackedVertex*>(vertexData(i));
+        xyz.resize(static_cast<size_t>(o.vertexCount) * 3);
+        for (uint32_t v = 0; v < o.vertexCount; v++)
+        {
+            for (int c = 0; c < 3; c++)
+                xyz[v * 3 + c] = o.boundsMin[c] + vertices[v].position[c] / 65535.0f * (o.boundsMax[c] - o.boundsMin[c]);
+        }
+    }
+
+    // the triangle list widened to 32 bit
+    void indices(unsigned int i, std::vector<uint32_t>& out) const
+    {
+        const ScenePackObject& o = object(i);
+        out.resize(o.indexCount);
+        if (o.indexSize == 2)
+        {
+            const uint16_t* in = static_cast<const uint16_t*>(indexData(i));
+            for (uint32_t k = 0; k < o.indexCount; k++)
+                out[k] = in[k];
+        }
+        else
+            std::memcpy(out.data(), indexData(i), indexBytes(i));
+    }
+
+private:
+    MappedFile m_file;
+
+    const ScenePackHeader& header() const
+    {
+        return *reinterpret_cast<const ScenePackHeader*>(m_file.data());
+    }
+
+    const ScenePackObject* objects() const
+    {
+        return reinterpret_cast<const ScenePackObject*>(m_file.data() + sizeof(ScenePackHeader));
+    }
+
+    // checks the header and that every blob lies inside the file, so a truncated or
+    // stale pack is rejected at load time instead of being read out of bounds later
+    bool validate() const
+    {
+        if (m_file.size() < sizeof(ScenePackHeader))
+            return false;
+        const ScenePackHeader& h = header();
+        if (h.magic != SCENE_PACK_MAGIC || h.version != SCENE_PACK_VERSION || h.fileSize != m_file.size() || h.vertexStride != sizeof(PackedVertex))
+            return false;
+        if (sizeof(ScenePackHeader) + uint64_t(h.objectCount) * sizeof(ScenePackObject) > m_file.size())
+            return false;
+        for (unsigned int i = 0; i < h.objectCount; i++)
+        {
+            const ScenePackObject& o = objects()[i];
+            if (o.name[SCENE_PACK_NAME_SIZE - 1] != '\0' || o.vertexOffset % SCENE_PACK_ALIGNMENT != 0 || o.indexOffset % SCENE_PACK_ALIGNMENT != 0)
+                return false;
+            if (o.indexSize != 2 && o.indexSize != 4)
+                return false;
+            if (o.vertexOffset + uint64_t(o.vertexCount) * h.vertexStride > m_file.size() ||
+                o.indexOffset + uint64_t(o.indexCount) * o.indexSize > m_file.size())
+                return false;
+        }
+        return true;
+    }
+};
+#endif
@@ -0,0 +1,149 @@
+// Compares cullBounds (learnopengl/frustum_culler.h) and BoundsTree::cullFrustum
+// (learnopengl/bounds_tree.h) with the per-object path: a BoundingVolume per object,
+// asked isOnFrustum(frustum, transform) one at a time through the virtual call,
+// rebuilding the world AABB on every test.
+//
+// The boxes are scattered around a camera at the origin looking down -z, each with
+// its own translation, rotation and scale. The batch path is timed twice: the cull
+// alone, and with the world bounds refreshed from the model matrices first, which is
+// what a scene with every object moving pays each frame.
+//
+// build: g++ -std=c++17 -O2 -I. tools/frustum_bench.cpp -o frustum_bench
+//        add -mavx for 8 boxes per step instead of 4
+// usage: frustum_bench [runs] [boxes...]      (default 20 runs of 10000 100000 1000000)
+#include "learnopengl/bounds_tree.h"
+#include "learnopengl/frustum_culler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <vector>
+
+struct Timing {
+    double min;
+    double median;
+};
+
+template <typename Function>
+static Timing timeRuns(int runs, Function&& function)
+{
+    std::vector<double> times;
+    for (int run = 0; run < runs; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return { times.front(), times[times.size() / 2] };
+}
+
+static void report(const char* name, const Timing& timing, size_t boxes)
+{
+    std::cout << "  " << name << ": min " << timing.min << " ms, median " << timing.median << " ms ("
+              << timing.min * 1e6 / boxes << " ns per box)" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    const int runs = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20;
+    std::vector<size_t> sizes;
+    for (int i = 2; i < argc; i++)
+        sizes.push_back(static_cast<size_t>(std::atoll(argv[i])));
+    if (sizes.empty())
+        sizes = { 10000, 100000, 1000000 };
+
+    // the default camera: at the origin, looking down -z
+    const Frustum frustum = createFrustum(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f),
+                                          16.0f / 9.0f, glm::radians(45.0f), 0.1f, 100.0f);
+
+#if defined(FRUSTUM_CULLER_AVX)
+    std::cout << "cullBounds: AVX, 8 boxes per step" << std::endl;
+#elif defined(FRUSTUM_CULLER_SSE)
+    std::cout << "cullBounds: SSE, 4 boxes per step" << std::endl;
+#else
+    std::cout << "cullBounds: scalar" << std::endl;
+#endif
+
+    for (size_t count : sizes)
+    {
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> position(-120.0f, 120.0f);
+        std::uniform_real_distribution<float> angle(0.0f, 360.0f);
+        std::uniform_real_distribution<float> size(0.2f, 3.0f);
+
+        // what Entity holds per object
+        std::vector<std::unique_ptr<BoundingVolume>> volumes;
+        std::vector<Transform> transforms(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            const glm::vec3 extent(size(random), size(random), size(random));
+            volumes.push_back(std::make_unique<AABB>(-extent, extent));
+            transforms[i].setLocalPosition(glm::vec3(position(random), position(random), position(random)));
+            transforms[i].setLocalRotation(glm::vec3(angle(random), angle(random), angle(random)));
+            transforms[i].setLocalScale(glm::vec3(size(random)));
+            transforms[i].computeModelMatrix();
+        }
+
+        std::vector<uint32_t> entityVisible;
+        entityVisible.reserve(count);
+        const Timing entityTiming = timeRuns(runs, [&]() {
+            entityVisible.clear();
+            for (size_t i = 0; i < count; i++)
+            {
+                if (volumes[i]->isOnFrustum(frustum, transforms[i]))
+                    entityVisible.push_back(static_cast<uint32_t>(i));
+            }
+        });
+
+        CullingBounds bounds;
+        bounds.resize(count);
+        auto refreshBounds = [&]() {
+            for (size_t i = 0; i < count; i++)
+                bounds.set(static_cast<uint32_t>(i), static_cast<const AABB&>(*volumes[i]).transformed(transforms[i].getModelMatrix()));
+        };
+        refreshBounds();
+
+        std::vector<uint32_t> batchVisible;
+        batchVisible.reserve(count);
+        const Timing cullTiming = timeRuns(runs, [&]() { cullBounds(frustum, bounds, batchVisible); });
+        const Timing refreshTiming = timeRuns(runs, [&]() {
+            refreshBounds();
+            cullBounds(frustum, bounds, batchVisible);
+        });
+
+        std::vector<BoundsTreeItem> items;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const glm::vec3 center(bounds.centerX[i], bounds.centerY[i], bounds.centerZ[i]);
+            const glm::vec3 extents(bounds.extentX[i], bounds.extentY[i], bounds.extentZ[i]);
+            items.push_back({ i, center - extents, center + extents });
+        }
+        BoundsTree tree;
+        const Timing buildTiming = timeRuns(std::max(1, runs / 4), [&]() { tree.build(items); });
+        std::vector<uint32_t> treeVisible;
+        const Timing treeTiming = timeRuns(runs, [&]() { tree.cullFrustum(frustum, treeVisible); });
+        std::sort(treeVisible.begin(), treeVisible.end());
+
+        // the two paths round differently, so a box touching a plane may land on either side
+        std::vector<uint32_t> differing;
+        std::set_symmetric_difference(entityVisible.begin(), entityVisible.end(), batchVisible.begin(), batchVisible.end(),
+                                      std::back_inserter(differing));
+
+        std::cout << count << " boxes, " << batchVisible.size() << " visible (" << differing.size()
+                  << " differ from the per-entity path), best of " << runs << " runs" << std::endl;
+        report("per-entity isOnFrustum", entityTiming, count);
+        report("cullBounds", cullTiming, count);
+        report("bounds refresh + cullBounds", refreshTiming, count);
+        report("BoundsTree::cullFrustum", treeTiming, count);
+        std::cout << "  BoundsTree: built in " << buildTiming.min << " ms, " << tree.visitedNodes() << " of " << 2 * count - 1
+                  << " nodes visited, " << (treeVisible == batchVisible ? "same" : "DIFFERENT") << " result as cullBounds" << std::endl;
+        std::cout << "  speedup: " << entityTiming.min / cullTiming.min << "x cull only, "
+                  << entityTiming.min / refreshTiming.min << "x with refresh, " << entityTiming.min / treeTiming.min << "x tree" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+// Compares the load time and peak memory of loadObj (learnopengl/obj_loader.h) with the
+// Assimp import done by learnopengl/model.h's Model::loadModel.
+//
+// Peak memory is the process's high-water mark, so each loader runs in its own process:
+//   obj_bench fast ../3d-model.obj
+//   obj_bench assimp ../3d-model.obj
+//
+// build: g++ -std=c++17 -O2 -pthread -I. tools/obj_bench.cpp -o obj_bench
+//        add -DOBJ_BENCH_ASSIMP -lassimp for the assimp mode (and -lpsapi on Windows)
+// usage: obj_bench <fast|assimp> <file.obj> [runs] [threads]
+#include "learnopengl/obj_loader.h"
+
+#ifdef OBJ_BENCH_ASSIMP
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#endif
+
+#ifdef _WIN32
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// peak resident memory of this process so far, in MB
+static double peakMemoryMB()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+    return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+#endif
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "usage: obj_bench <fast|assimp> <file.obj> [runs] [threads]" << std::endl;
+        return 1;
+    }
+    const std::string mode = argv[1];
+    const std::string path = argv[2];
+    const int runs = argc > 3 ? std::max(1, std::atoi(argv[3])) : 10;
+    const unsigned int threads = argc > 4 ? static_cast<unsigned int>(std::atoi(argv[4])) : 0;
+
+    const double baseMemory = peakMemoryMB();
+    std::vector<double> times;
+    size_t vertices = 0, indices = 0, groups = 0;
+
+    if (mode == "fast")
+    {
+        ThreadPool workers(threads);
+        std::cout << "loadObj on " << workers.size() << " threads" << std::endl;
+        for (int run = 0; run < runs; run++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            ObjMesh mesh;
+            if (!loadObj(path, mesh, workers))
+                return 1;
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            vertices = mesh.vertices.size();
+            indices = mesh.indices.size();
+            groups = mesh.groups.size();
+        }
+    }
+#ifdef OBJ_BENCH_ASSIMP
+    else if (mode == "assimp")
+    {
+        std::cout << "Assimp with Model::loadModel's flags" << std::endl;
+        for (int run = 0; run < runs; run++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            Assimp::Importer importer;
+            const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+            if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+            {
+                std::cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << std::endl;
+                return 1;
+            }
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            vertices = indices = 0;
+            for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+            {
+                vertices += scene->mMeshes[i]->mNumVertices;
+                indices += scene->mMeshes[i]->mNumFaces * 3;
+            }
+            groups = scene->mNumMeshes;
+        }
+    }
+#endif
+    else
+    {
+        std::cout << "ERROR::OBJ_BENCH::UNKNOWN_MODE: " << mode << " (assimp needs -DOBJ_BENCH_ASSIMP)" << std::endl;
+        return 1;
+    }
+
+    std::sort(times.begin(), times.end());
+    std::cout << vertices << " vertices, " << indices << " indices, " << groups << " meshes/materials" << std::endl;
+    std::cout << "load: min " << times.front() << " ms, median " << times[times.size() / 2] << " ms over " << runs << " runs" << std::endl;
+    std::cout << "peak memory: " << peakMemoryMB() << " MB (" << peakMemoryMB() - baseMemory << " MB above startup)" << std::endl;
+    return 0;
+}
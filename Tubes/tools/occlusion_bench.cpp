@@ -0,0 +1,168 @@
+// Runs OcclusionCuller (learnopengl/occlusion_culler.h) on scene/island.pack without
+// a window or GL context. The mountains and the igloo are the occluders, drawn from
+// their own pack meshes, and every island object is tested against them from a few
+// camera positions around the island.
+//
+// For each view it prints the objects found hidden, the time to draw the occluders
+// (binning and rasterizing) and to test all objects. Every hidden object is then
+// checked by rasterizing its own mesh alone: no pixel of it may come out nearer than
+// the occluders' depth there, or the culler hid something that is on screen.
+//
+// build: g++ -std=c++17 -O2 -I. tools/occlusion_bench.cpp -o occlusion_bench -pthread
+//        add -U__SSE__ to time the scalar rasterizer
+// usage: occlusion_bench [runs] [depth.pgm]    (default 200 runs; the pgm is the last view's depth)
+#include "scene_pack.h"
+#include "learnopengl/occlusion_culler.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+struct View {
+    const char* name;
+    glm::vec3 position;
+    glm::vec3 target;
+};
+
+template <typename Function>
+static double minTime(int runs, Function&& function)
+{
+    double best = 1e30;
+    for (int run = 0; run < runs; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+// the depth buffer as an 8-bit grey image, near is dark, no occluder is white
+static void writeDepth(const char* path, const float* depth)
+{
+    std::ofstream file(path, std::ios::binary);
+    file << "P5\n" << OcclusionCuller::WIDTH << " " << OcclusionCuller::HEIGHT << "\n255\n";
+    for (int y = OcclusionCuller::HEIGHT - 1; y >= 0; y--)
+    {
+        for (int x = 0; x < OcclusionCuller::WIDTH; x++)
+        {
+            const float z = depth[y * OcclusionCuller::WIDTH + x];
+            // NDC depth bunches up near 1, so spread it back out
+            const float linear = z >= 1.0f ? 1.0f : std::pow(std::max(z, 0.0f), 64.0f);
+            file.put(static_cast<char>(255.0f * linear));
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const int runs = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200;
+    const char* pgmPath = argc > 2 ? argv[2] : nullptr;
+
+    ScenePack island;
+    if (!island.load("scene/island.pack"))
+        return 1;
+
+    const char* occluderNames[] = { "GreyMountain", "BlackMountain", "WhiteMountain", "IgloHouse" };
+    std::vector<OccluderMesh> occluders;
+    for (const char* name : occluderNames)
+    {
+        const int i = island.find(name);
+        if (i < 0)
+        {
+            std::cout << "ERROR::OCCLUSION_BENCH::MISSING_OBJECT: " << name << std::endl;
+            return 1;
+        }
+        OccluderMesh mesh;
+        island.positions(i, mesh.positions);
+        island.indices(i, mesh.indices);
+        occluders.push_back(std::move(mesh));
+    }
+
+    // every object as it sits in the pack, the animated ones at their rest position
+    std::vector<OccluderMesh> meshes(island.objectCount());
+    for (unsigned int i = 0; i < island.objectCount(); i++)
+    {
+        island.positions(i, meshes[i].positions);
+        island.indices(i, meshes[i].indices);
+    }
+
+    const View views[] = {
+        { "start", glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 0.0f, 0.0f) },
+        { "above", glm::vec3(0.0f, 6.0f, 4.0f), glm::vec3(0.0f, -1.5f, 0.0f) },
+        { "behind the igloo", glm::vec3(2.4f, -1.35f, 2.3f), glm::vec3(1.2f, -1.4f, 1.1f) },
+        { "east", glm::vec3(7.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.4f, 0.0f) },
+        { "north, low", glm::vec3(0.0f, -0.8f, -7.0f), glm::vec3(0.0f, -1.4f, 0.0f) },
+        { "north-east, low", glm::vec3(4.95f, -0.8f, -4.95f), glm::vec3(0.0f, -1.4f, 0.0f) },
+        { "north-west", glm::vec3(-4.95f, 0.0f, -4.95f), glm::vec3(0.0f, -1.4f, 0.0f) },
+    };
+
+#if defined(OCCLUSION_CULLER_SSE)
+    std::cout << "OcclusionCuller: SSE, 4 pixels per step";
+#else
+    std::cout << "OcclusionCuller: scalar";
+#endif
+    ThreadPool workers;
+    std::cout << ", " << workers.size() << " worker threads, " << OcclusionCuller::WIDTH << "x" << OcclusionCuller::HEIGHT
+              << " depth, best of " << runs << " runs" << std::endl;
+
+    OcclusionCuller culler(workers);
+    OcclusionCuller single(workers);
+    int failures = 0;
+    for (const View& view : views)
+    {
+        const glm::mat4 viewProjection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f)
+                                         * glm::lookAt(view.position, view.target, glm::vec3(0.0f, 1.0f, 0.0f));
+        const double renderTime = minTime(runs, [&]() {
+            culler.begin(viewProjection);
+            for (const OccluderMesh& mesh : occluders)
+                culler.addOccluder(mesh, glm::mat4(1.0f));
+            culler.render();
+        });
+
+        std::vector<unsigned int> hidden;
+        const double testTime = minTime(runs, [&]() {
+            hidden.clear();
+            for (unsigned int i = 0; i < island.objectCount(); i++)
+            {
+                const ScenePackObject& object = island.object(i);
+                if (!culler.isVisible(glm::vec3(object.boundsMin[0], object.boundsMin[1], object.boundsMin[2]),
+                                      glm::vec3(object.boundsMax[0], object.boundsMax[1], object.boundsMax[2])))
+                    hidden.push_back(i);
+            }
+        });
+
+        std::cout << view.name << ": " << culler.triangleCount() << " occluder triangles on screen, " << hidden.size() << "/"
+                  << island.objectCount() << " objects hidden" << std::endl;
+        std::cout << "  draw occluders " << renderTime << " ms, test objects " << testTime << " ms" << std::endl;
+        std::cout << "  hidden:";
+        for (unsigned int i : hidden)
+        {
+            std::cout << " " << island.object(i).name;
+
+            single.begin(viewProjection);
+            single.addOccluder(meshes[i], glm::mat4(1.0f));
+            single.render();
+            int exposed = 0;
+            for (int p = 0; p < OcclusionCuller::WIDTH * OcclusionCuller::HEIGHT; p++)
+                exposed += single.depth()[p] < culler.depth()[p] ? 1 : 0;
+            if (exposed > 0)
+            {
+                std::cout << " (" << exposed << " pixels in front of the occluders!)";
+                failures++;
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    if (pgmPath)
+        writeDepth(pgmPath, culler.depth());
+    std::cout << (failures == 0 ? "no hidden object has a visible pixel" : "FAILED: hidden objects with visible pixels") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,263 @@
+// Cooks the hand-authored object arrays into the binary scene pack loaded by main.cpp.
+//
+// Every `float Name[] = { ... };` block of the input is one object, in file order.
+// Blocks that don't hold whole 8-float vertices (like skyboxVertices) are skipped.
+// Each object's triangle soup is welded into unique vertices plus a 16-bit index list
+// (32-bit only if an object ever grows past 65535 unique vertices), then every vertex
+// is quantized into a 12-byte PackedVertex relative to the object's bounds.
+//
+// build: g++ -std=c++17 -O2 tools/pack_scene.cpp -o pack_scene
+// usage: pack_scene scene/island_objects.inc scene/island.pack
+#include "../scene_pack.h"
+#include "../learnopengl/vertex_weld.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cfloat>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+const unsigned int FLOATS_PER_VERTEX = 8;
+
+struct SourceObject {
+    std::string name;
+    std::vector<float> vertices;
+};
+
+// removes // and /* */ comments so they can't be mistaken for numbers
+static std::string stripComments(const std::string& text)
+{
+    std::string out;
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        if (text[i] == '/' && i + 1 < text.size() && text[i + 1] == '/')
+        {
+            while (i < text.size() && text[i] != '\n')
+                i++;
+            out += '\n';
+        }
+        else if (text[i] == '/' && i + 1 < text.size() && text[i + 1] == '*')
+        {
+            size_t end = text.find("*/", i + 2);
+            i = (end == std::string::npos) ? text.size() : end + 1;
+        }
+        else
+            out += text[i];
+    }
+    return out;
+}
+
+static bool parseObjects(const std::string& source, std::vector<SourceObject>& objects)
+{
+    const std::string text = stripComments(source);
+    size_t pos = 0;
+    while ((pos = text.find("float ", pos)) != std::string::npos)
+    {
+        size_t nameBegin = pos + 6;
+        size_t nameEnd = nameBegin;
+        while (nameEnd < text.size() && (std::isalnum((unsigned char)text[nameEnd]) || text[nameEnd] == '_'))
+            nameEnd++;
+        size_t open = text.find_first_not_of(" \t", nameEnd);
+        if (nameEnd == nameBegin || open == std::string::npos || text.compare(open, 2, "[]") != 0)
+        {
+            pos = nameEnd;
+            continue;
+        }
+        size_t bodyBegin = text.find('{', open);
+        size_t bodyEnd = text.find('}', bodyBegin);
+        if (bodyBegin == std::string::npos || bodyEnd == std::string::npos)
+        {
+            std::cout << "ERROR::PACK_SCENE::UNTERMINATED_ARRAY: " << text.substr(nameBegin, nameEnd - nameBegin) << std::endl;
+            return false;
+        }
+
+        SourceObject object;
+        object.name = text.substr(nameBegin, nameEnd - nameBegin);
+        const char* p = text.c_str() + bodyBegin + 1;
+        const char* end = text.c_str() + bodyEnd;
+        while (p < end)
+        {
+            if (std::isspace((unsigned char)*p) || *p == ',')
+            {
+                p++;
+                continue;
+            }
+            char* next = nullptr;
+            float value = std::strtof(p, &next);
+            if (next == p)
+            {
+                std::cout << "ERROR::PACK_SCENE::BAD_NUMBER in " << object.name << ": " << std::string(p, std::min<size_t>(16, end - p)) << std::endl;
+                return false;
+            }
+            object.vertices.push_back(value);
+            p = next;
+            if (p < end && (*p == 'f' || *p == 'F'))
+                p++;
+        }
+        pos = bodyEnd;
+
+        if (object.vertices.size() % FLOATS_PER_VERTEX != 0)
+        {
+            std::cout << "skipping " << object.name << ": " << object.vertices.size() << " floats is not a whole number of vertices" << std::endl;
+            continue;
+        }
+        if (object.name.size() >= SCENE_PACK_NAME_SIZE)
+        {
+            std::cout << "ERROR::PACK_SCENE::NAME_TOO_LONG: " << object.name << std::endl;
+            return false;
+        }
+        objects.push_back(std::move(object));
+    }
+    return true;
+}
+
+static uint16_t quantizeUnit(float value, float minValue, float maxValue)
+{
+    if (maxValue <= minValue)
+        return 0;
+    float t = (value - minValue) / (maxValue - minValue);
+    return static_cast<uint16_t>(std::lround(std::min(std::max(t, 0.0f), 1.0f) * 65535.0f));
+}
+
+static uint8_t quantizeColor(float value)
+{
+    return static_cast<uint8_t>(std::lround(std::min(std::max(value, 0.0f), 1.0f) * 255.0f));
+}
+
+static std::vector<PackedVertex> packVertices(const WeldedMesh& mesh, const ScenePackObject& o, uint16_t objectIndex)
+{
+    std::vector<PackedVertex> packed(mesh.vertexCount());
+    for (size_t v = 0; v < packed.size(); v++)
+    {
+        const float* src = &mesh.vertices[v * FLOATS_PER_VERTEX];
+        for (int k = 0; k < 3; k++)
+        {
+            packed[v].position[k] = quantizeUnit(src[k], o.boundsMin[k], o.boundsMax[k]);
+            packed[v].color[k] = quantizeColor(src[3 + k]);
+        }
+        packed[v].object = objectIndex;
+        packed[v].color[3] = 255;
+    }
+    return packed;
+}
+
+static bool writePack(const char* path, const std::vector<SourceObject>& objects)
+{
+    const uint32_t stride = sizeof(PackedVertex);
+    if (objects.size() > 0xFFFF)
+    {
+        std::cout << "ERROR::PACK_SCENE::TOO_MANY_OBJECTS: " << objects.size() << std::endl;
+        return false;
+    }
+
+    std::vector<WeldedMesh> welded(objects.size());
+    std::vector<ScenePackObject> table(objects.size());
+    uint64_t offset = alignScenePackOffset(sizeof(ScenePackHeader) + table.size() * sizeof(ScenePackObject));
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        const std::vector<float>& source = objects[i].vertices;
+        welded[i] = weldVertices(source.data(), source.size() / FLOATS_PER_VERTEX, FLOATS_PER_VERTEX);
+        const WeldedMesh& mesh = welded[i];
+
+        ScenePackObject& o = table[i];
+        std::memset(&o, 0, sizeof(o));
+        std::strncpy(o.name, objects[i].name.c_str(), SCENE_PACK_NAME_SIZE - 1);
+        o.vertexCount = mesh.vertexCount();
+        o.indexCount = static_cast<uint32_t>(mesh.indices.size());
+        o.indexSize = mesh.fitsShortIndices() ? 2 : 4;
+        for (int k = 0; k < 3; k++)
+        {
+            o.boundsMin[k] = FLT_MAX;
+            o.boundsMax[k] = -FLT_MAX;
+        }
+        for (size_t j = 0; j < mesh.vertices.size(); j += FLOATS_PER_VERTEX)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                o.boundsMin[k] = std::min(o.boundsMin[k], mesh.vertices[j + k]);
+                o.boundsMax[k] = std::max(o.boundsMax[k], mesh.vertices[j + k]);
+            }
+        }
+        o.vertexOffset = offset;
+        offset = alignScenePackOffset(offset + uint64_t(o.vertexCount) * stride);
+        o.indexOffset = offset;
+        offset = alignScenePackOffset(offset + uint64_t(o.indexCount) * o.indexSize);
+    }
+
+    ScenePackHeader header;
+    header.magic = SCENE_PACK_MAGIC;
+    header.version = SCENE_PACK_VERSION;
+    header.objectCount = static_cast<uint32_t>(table.size());
+    header.vertexStride = stride;
+    header.fileSize = offset;
+
+    std::vector<unsigned char> file(offset, 0);
+    std::memcpy(file.data(), &header, sizeof(header));
+    std::memcpy(file.data() + sizeof(header), table.data(), table.size() * sizeof(ScenePackObject));
+    for (size_t i = 0; i < objects.size(); i++)
+    {
+        const WeldedMesh& mesh = welded[i];
+        std::vector<PackedVertex> packed = packVertices(mesh, table[i], static_cast<uint16_t>(i));
+        std::memcpy(file.data() + table[i].vertexOffset, packed.data(), packed.size() * sizeof(PackedVertex));
+        if (table[i].indexSize == 2)
+        {
+            std::vector<uint16_t> indices = mesh.shortIndices();
+            std::memcpy(file.data() + table[i].indexOffset, indices.data(), indices.size() * sizeof(uint16_t));
+        }
+        else
+            std::memcpy(file.data() + table[i].indexOffset, mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(file.data()), file.size());
+    if (!out)
+    {
+        std::cout << "ERROR::PACK_SCENE::WRITE_FAILED: " << path << std::endl;
+        return false;
+    }
+
+    size_t sourceVertices = 0, weldedVertices = 0;
+    for (size_t i = 0; i < table.size(); i++)
+    {
+        sourceVertices += table[i].indexCount;
+        weldedVertices += table[i].vertexCount;
+        std::cout << i << " " << table[i].name << ": " << table[i].indexCount << " -> " << table[i].vertexCount << " vertices" << std::endl;
+    }
+    std::cout << "welded " << sourceVertices << " vertices into " << weldedVertices << " (" << sizeof(PackedVertex)
+              << " instead of " << FLOATS_PER_VERTEX * sizeof(float) << " bytes each)" << std::endl;
+    std::cout << "wrote " << path << " (" << file.size() << " bytes)" << std::endl;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cout << "usage: pack_scene <objects source> <output pack>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in)
+    {
+        std::cout << "ERROR::PACK_SCENE::FILE_NOT_SUCCESFULLY_READ: " << argv[1] << std::endl;
+        return 1;
+    }
+    std::stringstream source;
+    source << in.rdbuf();
+
+    std::vector<SourceObject> objects;
+    if (!parseObjects(source.str(), objects))
+        return 1;
+    if (objects.empty())
+    {
+        std::cout << "ERROR::PACK_SCENE::NO_OBJECTS in " << argv[1] << std::endl;
+        return 1;
+    }
+    return writePack(argv[2], objects) ? 0 : 1;
+}
@@ -11,6 +11,10 @@
 
 #include <learnopengl/shader_m.h>
 #include <learnopengl/camera.h>
+#include <learnopengl/vertex_weld.h>
+#include <learnopengl/draw_range.h>
+#include <learnopengl/gl_state.h>
+#include <learnopengl/texture_cache.h>
 #include <iostream>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -69,6 +73,8 @@ int main()
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    // linked shader programs are restored from shader_cache/ when nothing changed
+    initProgramCache((GLADloadproc)glfwGetProcAddress);
 
     // configure global opengl state
     // -----------------------------
@@ -77,6 +83,8 @@ int main()
     // build and compile our shader zprogram
     // ------------------------------------
     Shader ourShader("4.1.texture.vs", "4.1.texture.fs");
+    std::cout << "shader programs: " << programCacheStats().hits << " from cache, "
+              << programCacheStats().misses << " compiled" << std::endl;
     sndPlaySound("sound.wav", SND_ASYNC);
 
     // set up vertex data (and buffer(s)) and configure vertex attributes
@@ -2480,10 +2488,29 @@ int main()
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
 
-    glBindVertexArray(VAO);
+    glState.bindVertexArray(VAO);
+
+    // weld the triangle soup so shared corners are stored once and drawn through the EBO
+    WeldedMesh pohon = weldVertices(pohonkering, sizeof(pohonkering) / (8 * sizeof(float)), 8);
+    GLenum pohonIndexType = pohon.fitsShortIndices() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(pohonkering), pohonkering, GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, pohon.vertices.size() * sizeof(float), pohon.vertices.data(), GL_STATIC_DRAW);
+
+    // the draw range is built from the same index data the EBO gets
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    DrawRange pohonRange;
+    if (pohonIndexType == GL_UNSIGNED_SHORT)
+    {
+        std::vector<uint16_t> shortIndices = pohon.shortIndices();
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+        pohonRange = elementDrawRange(VAO, GL_UNSIGNED_SHORT, shortIndices.data(), static_cast<GLsizei>(shortIndices.size()), pohon.vertexCount());
+    }
+    else
+    {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, pohon.indices.size() * sizeof(unsigned int), pohon.indices.data(), GL_STATIC_DRAW);
+        pohonRange = elementDrawRange(VAO, GL_UNSIGNED_INT, pohon.indices.data(), static_cast<GLsizei>(pohon.indices.size()), pohon.vertexCount());
+    }
 
     // position attribute
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
@@ -2502,27 +2529,32 @@ int main()
     // texture 1
     // ---------
     glGenTextures(1, &texture1);
-    glBindTexture(GL_TEXTURE_2D, texture1);
+    glState.bindTexture(0, GL_TEXTURE_2D, texture1);
     // set the texture wrapping parameters
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     // set texture filtering parameters
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // load image, create texture and generate mipmaps
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-    unsigned char *data = stbi_load("texture.jpg", &width, &height, &nrChannels, 0);
-    if (data)
+    // load the compressed image and its mipmaps (decoded only when it isn't in the
+    // texture cache yet), flipped on the y-axis for OpenGL
+    TextureCache textureCache("texture_cache", stbi_load_from_memory, stbi_image_free);
+    // cached textures are BC1/BC3, or plain RGBA8 where the driver has no S3TC
+    if (!textureCompressionSupported())
+    {
+        std::cout << "texture cache: no S3TC support, textures stay uncompressed" << std::endl;
+        textureCache.setCompression(false);
+    }
+    CompressedImage image;
+    if (textureCache.load("texture.jpg", true, image))
     {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(image.levels.size()) - 1);
+        uploadCompressedImage(GL_TEXTURE_2D, image);
     }
     else
     {
         std::cout << "Failed to load texture" << std::endl;
     }
-    stbi_image_free(data);
 
     // tell opengl for each sampler to which texture unit it belongs to (only has to be done once)
     // -------------------------------------------------------------------------------------------
@@ -2549,22 +2581,21 @@ int main()
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         // bind textures on corresponding texture units
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture1);
+        glState.bindTexture(0, GL_TEXTURE_2D, texture1);
 
         // activate shader
         ourShader.use();
 
         // pass projection matrix to shader (note that in this case it could change every frame)
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        ourShader.setMat4("projection", projection);
+        ourShader.setMat4("projection"_uniform, projection);
 
         // camera/view transformation
         glm::mat4 view = camera.GetViewMatrix();
-        ourShader.setMat4("view", view);
+        ourShader.setMat4("view"_uniform, view);
 
         // render boxes
-        glBindVertexArray(VAO);
+        glState.bindVertexArray(VAO);
         //for (unsigned int i = 0; i < 10; i++)
         //{
             // calculate the model matrix for each object and pass it to shader before drawing
@@ -2572,9 +2603,9 @@ int main()
             model = glm::translate(model, cubePositions[0]);
             float angle = 20.0f * 0;
             model = glm::rotate(model, glm::radians(angle), glm::vec3(1.0f, 0.3f, 0.5f));
-            ourShader.setMat4("model", model);
+            ourShader.setMat4("model"_uniform, model);
 
-            glDrawArrays(GL_TRIANGLES, 0, 30000);
+            drawRange(pohonRange);
         //}
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
@@ -2585,7 +2616,7 @@ int main()
 
     // optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
-    glDeleteVertexArrays(1, &VAO);
+    glState.deleteVertexArray(VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
 